@@ -0,0 +1,39 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file assertion.h
+/// @brief Self-implemented Assert Function
+/// @details Unlike assert(), it stays in release builds and tells why it @n
+///          fails. This file is both header file and source file.
+///
+/// @section purpose_section Purpose
+/// Condition check shared by learning libraries
+///
+
+#ifndef __ASSERTION__
+#define __ASSERTION__
+
+#include <iostream>
+#include <cstdlib>
+
+#ifndef NULL
+#define NULL 0
+#endif  /* NULL */
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief exiting with message if condition is false
+///
+/// @param exp condition expected to be true
+/// @param message error message ( NULL if none )
+///
+
+static inline void ASSERT(bool exp, char* message = NULL) {
+  if (!exp) {
+    std::cout << "ASSERT" << std::endl;
+    if (message)
+      std::cout << "ERROR: " << message << std::endl;
+    exit(-1);
+  }
+}
+
+#endif /* __ASSERTION__ */
@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file boost.h
+/// @brief AdaBoost Library Header File
+/// @details Boosted ensemble of shallow ID3 trees. Each round trains one @n
+///          depth-limited tree on the whole shared column-oriented data set @n
+///          under instance weights, then raises the weights of rows the tree @n
+///          gets wrong. Trees predict by a vote weighted with their accuracy.
+///
+/// @section reference_section Reference
+/// A DECISION-THEORETIC GENERALIZATION OF ON-LINE LEARNING AND AN APPLICATION
+/// TO BOOSTING - YOAV FREUND, ROBERT E. SCHAPIRE
+/// MULTI-CLASS ADABOOST - JI ZHU, HUI ZOU, SAHARON ROSSET, TREVOR HASTIE
+///
+/// @section purpose_section Purpose
+/// Application trial for personal studying
+///
+
+#ifndef __ADABOOST__
+#define __ADABOOST__
+
+#include "ensemble.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief AdaBoost Class
+/// @details multi-class boosting ( SAMME ); a tree only has to beat random @n
+///          guess ( 1 / nr_class error ) to get positive vote weight
+///
+
+class Boost : public Ensemble {
+private:
+  DataSet   *data;        ///< column-oriented data set shared by all rounds
+  int       nr_round;     ///< the maximum number of boosting rounds
+  int       maxDepth;     ///< the maximum depth of member trees
+  int       nr_bin;       ///< the maximum number of histogram bins ( 0 if not used )
+  bool      level;        ///< true if trees grow level by level
+  double    chiLevel;     ///< significance level of chi-square split test ( 0 means no test )
+  int       minRows;      ///< the minimum number of rows to split a node ( 0 means no limit )
+  int       nr_error;     ///< the number of training rows the ensemble gets wrong
+
+  /// @brief predicting training rows by one tree
+  /// @details rows are gathered from columns one block at a time
+  ///
+  /// @param tree member tree
+  /// @param out target attribute values predicted ( one per training row )
+  void predictTrain(ID3 *tree, ATTVAL *out);
+
+public:
+  /// @name constructor
+  /// @{
+
+  /// @brief constructor taking initial values
+  ///
+  /// @param attSizes attributes sizes array
+  /// @param nr_att the number of attributes
+  /// @param data training data set ( owned )
+  /// @param nr_round the maximum number of boosting rounds
+  /// @param maxDepth the maximum depth of member trees
+  Boost(ATTVAL *attSizes, ATTINDEX nr_att, DataSet *data, int nr_round, int maxDepth);
+  /// @}
+
+  /// @name destructor
+  /// @{
+
+  /// @brief default destructor
+  ~Boost(void);
+  /// @}
+
+  /// @name informative attributes
+  /// @{
+
+  /// @brief getting the number of rounds made
+  /// @details boosting stops early when a tree is perfect or no better @n
+  ///          than random guess
+  ///
+  /// @retval the number of member trees
+  int getNrRound(void) const;
+
+  /// @brief getting training error rate of ensemble
+  ///
+  /// @retval wrong rows / training rows
+  double getTrainError(void) const;
+  /// @}
+
+  /// @name functional attributes
+  /// @{
+
+  /// @brief making member trees round by round
+  void makeBoost(void);
+
+  /// @brief setting histogram mode of trees
+  ///
+  /// @param nr_bin the maximum number of bins per attr ( 0 turns it off )
+  void setNrBin(int nr_bin);
+
+  /// @brief setting level-wise ( breadth first ) growth of trees
+  ///
+  /// @param level true for level by level, false for depth first
+  void setLevelWise(bool level);
+
+  /// @brief setting chi-square pre-pruning of trees
+  ///
+  /// @param chiLevel significance level of split test ( 0 means no test )
+  void setSignificance(double chiLevel);
+
+  /// @brief setting the minimum number of rows to split a tree node
+  ///
+  /// @param minRows the minimum number of rows ( 0 means no limit )
+  void setMinRows(int minRows);
+  /// @}
+};
+
+#endif /* __ADABOOST__ */
@@ -129,6 +129,7 @@ private:
     List <Hypothesis*> *sb_Array;   ///< set of hypothesis in most specific bound
     int size;                       ///< the number of attributes except for target attribute
     friend class G_Bound;
+    friend class CE;
 
 public:
     /// @name constructor
@@ -193,6 +194,7 @@ class G_Bound {
 private:
     List <Hypothesis*> *gb_Array;    ///< set of hypothesis in most general bound
     int size;                        ///< the number of attributes except for target attribute
+    friend class CE;
 
 public:
     /// @name constructor
@@ -262,6 +264,19 @@ private:
     G_Bound* g_bound;    ///< Most General Bound
     int size;        ///< the number of attribute except for target attribute
 
+    /// @brief counting version space hypotheses without enumerating them
+    /// @details Version space is an union of intervals [s, g] for every @n
+    ///          s in S_Bound and g in G_Bound. Hypotheses outside of every @n
+    ///          interval are counted as models of one clause per interval @n
+    ///          ( DPLL-style branching on attributes with unit propagation, @n
+    ///          counting the rest of a branch at once when no clause is @n
+    ///          left ), and subtracted from all hypotheses. All hypotheses @n
+    ///          having 'null' are counted as one empty hypothesis.
+    /// @param u_input new instance ( NULL if only total count is wanted )
+    /// @param all the number of hypotheses in version space
+    /// @param pos the number of hypotheses in version space covering u_input
+    void countVS(bool* u_input, double &all, double &pos);
+
 public:
     /// @name constructor
     /// @{
@@ -295,6 +310,28 @@ public:
     /// @retval r_false if all version space hypotheses vote false
     /// @retval r_dontknow if hypotheses vote unanimously
     Result predict(bool* u_input);
+
+    /// @brief voting for new unknown instance with whole version space
+    ///
+    /// @param u_input new unknown instance with no target attribute
+    /// @retval the fraction of version space hypotheses voting true
+    /// @retval -1 if version space is empty
+    double vote(bool* u_input);
+
+    /// @brief the number of hypotheses in version space
+    ///
+    /// @retval version space size ( semantically distinct hypotheses )
+    double sizeVS(void);
+
+    /// @brief synthesizing the most informative query instance
+    /// @details Optimal query strategy splits version space in half. @n
+    ///          Starting from an instance covered by version space bound, @n
+    ///          attribute flips are taken greedily while the vote fraction @n
+    ///          approaches 0.5 ( flips which don't matter are never taken ).
+    /// @param query instance array to be filled ( size )
+    /// @retval the fraction of version space hypotheses voting true for query
+    /// @retval -1 if version space is empty
+    double query(bool* query);
     /// @}
 };
 
@@ -0,0 +1,168 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file crossvalid.h
+/// @brief Cross Validation Library Header File
+/// @details k-fold cross validation of ID3 on one shared column-oriented @n
+///          data set. Rows are shuffled once into k folds; each fold tree @n
+///          is trained on a row index view of the other folds and tested @n
+///          on its own, so no row is copied. Folds are trained concurrently.
+///
+/// @section reference_section Reference
+/// A STUDY OF CROSS-VALIDATION AND BOOTSTRAP FOR ACCURACY ESTIMATION AND
+/// MODEL SELECTION - RON KOHAVI
+///
+/// @section purpose_section Purpose
+/// Application trial for personal studying
+///
+
+#ifndef __CROSSVALID__
+#define __CROSSVALID__
+
+#include "decision.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief Cross Validation Class
+/// @details fold trees are ensemble members, so they are not pruned; @n
+///          every other ID3 option is applied to each of them
+///
+
+class CrossValid {
+private:
+  ATTVAL    *attSizes;    ///< attribute size information array including target attr ( not owned )
+  ATTINDEX  nr_att;       ///< the number of attributes including target attribute
+  DataSet   *data;        ///< column-oriented data set shared by all folds ( not owned )
+  int       nr_fold;      ///< the number of folds
+  int       *foldOf;      ///< fold of each row ( NULL until validate )
+  double    *accuracy;    ///< test accuracy of each fold
+  double    *msec;        ///< training time of each fold in msec
+  int       *nr_node;     ///< the number of nodes of each fold tree
+  int       nr_bin;       ///< the maximum number of histogram bins ( 0 if not used )
+  bool      level;        ///< true if trees grow level by level
+  int       maxDepth;     ///< the maximum depth of trees ( 0 means no limit )
+  double    chiLevel;     ///< significance level of chi-square split test ( 0 means no test )
+  int       minRows;      ///< the minimum number of rows to split a node ( 0 means no limit )
+  int       maxNodes;     ///< node budget of best-first growth ( 0 means no limit )
+  int       timeBudget;   ///< time budget of best-first growth in msec ( 0 means no limit )
+  bool      bitmap;       ///< true if trees may count by bitmap index
+  unsigned  seed;         ///< random seed of fold assignment
+  int       nr_thread;    ///< the number of threads of pool ( 0 means the number of cores )
+  WorkPool  *pool;        ///< thread pool shared by all folds ( NULL until first use )
+
+  /// @brief getting thread pool, starting it on first use
+  ///
+  /// @retval thread pool of nr_thread threads
+  WorkPool* getPool(void);
+
+  /// @brief training one fold tree on the other folds and testing it
+  ///
+  /// @param fold fold index
+  void runFold(int fold);
+
+  /// @brief runFold() task for WorkPool
+  ///
+  /// @param arg fold task argument
+  static void foldTask(void *arg);
+
+public:
+  /// @name constructor
+  /// @{
+
+  /// @brief constructor taking initial values
+  ///
+  /// @param attSizes attributes sizes array
+  /// @param nr_att the number of attributes
+  /// @param data data set to validate on ( not owned )
+  /// @param nr_fold the number of folds ( at most the number of rows )
+  CrossValid(ATTVAL *attSizes, ATTINDEX nr_att, DataSet *data, int nr_fold);
+  /// @}
+
+  /// @name destructor
+  /// @{
+
+  /// @brief default destructor
+  ~CrossValid(void);
+  /// @}
+
+  /// @name informative attributes
+  /// @{
+
+  /// @brief getting mean accuracy of folds
+  ///
+  /// @retval mean of fold accuracies ( 0 before validate )
+  double getMean(void) const;
+
+  /// @brief getting standard deviation of fold accuracies
+  ///
+  /// @retval sample standard deviation ( 0 if one fold )
+  double getStdDev(void) const;
+
+  /// @brief getting test accuracy of one fold
+  ///
+  /// @param fold fold index
+  /// @retval right rows / rows of fold
+  double getAccuracy(int fold) const;
+
+  /// @brief getting training time of one fold
+  ///
+  /// @param fold fold index
+  /// @retval wall time of training in msec
+  double getMsec(int fold) const;
+
+  /// @brief getting the number of nodes of one fold tree
+  ///
+  /// @param fold fold index
+  /// @retval the number of nodes
+  int getNrNode(int fold) const;
+  /// @}
+
+  /// @name functional attributes
+  /// @{
+
+  /// @brief training and testing all folds in parallel
+  void validate(void);
+
+  /// @brief setting the number of threads
+  ///
+  /// @param nr_thread the number of threads ( 0 means the number of cores )
+  void setNrThread(int nr_thread);
+
+  /// @brief setting histogram mode of trees
+  ///
+  /// @param nr_bin the maximum number of bins per attr ( 0 turns it off )
+  void setNrBin(int nr_bin);
+
+  /// @brief setting level-wise ( breadth first ) growth of trees
+  ///
+  /// @param level true for level by level, false for depth first
+  void setLevelWise(bool level);
+
+  /// @brief setting the maximum depth of trees
+  ///
+  /// @param maxDepth the maximum depth of trees ( 0 means no limit )
+  void setMaxDepth(int maxDepth);
+
+  /// @brief setting chi-square pre-pruning of trees
+  ///
+  /// @param chiLevel significance level of split test ( 0 means no test )
+  void setSignificance(double chiLevel);
+
+  /// @brief setting the minimum number of rows to split a tree node
+  ///
+  /// @param minRows the minimum number of rows ( 0 means no limit )
+  void setMinRows(int minRows);
+
+  /// @brief setting budgets of best-first growth of trees
+  ///
+  /// @param maxNodes the maximum number of tree nodes ( 0 means no limit )
+  /// @param timeBudget growing time budget in msec ( 0 means no limit )
+  void setBudget(int maxNodes, int timeBudget);
+
+  /// @brief setting bitmap index counting of trees
+  ///
+  /// @param bitmap true to count by bitmap index where it is cheaper
+  void setBitmap(bool bitmap);
+  /// @}
+};
+
+#endif /* __CROSSVALID__ */
@@ -20,6 +20,10 @@
 #ifndef __DECISIONTREE__
 #define __DECISIONTREE__
 
+#include <cstddef>
+#include <iostream>
+#include "pool.h"
+
 #ifndef NULL
 #define NULL 0
 #endif
@@ -56,7 +60,7 @@ public:
   /// @{
 
   /// @brief default destructor
-  ~DTreeNode(void);
+  virtual ~DTreeNode(void);
   /// @}
   
   virtual void for_polymorphism(void) = 0;
@@ -90,6 +94,11 @@ private:
   ATTINDEX attIndex;      ///< next test attr
   DTreeNode **child;      ///< The array of child node (array index means attr possible value)
   ATTVAL nr_child;        ///< The number of child branch
+  ATTVAL major;           ///< the most common target value of training examples here
+  bool numeric;           ///< true if binary threshold test on continuous attr
+  ATTVAL threshold;       ///< child 0 if value <= threshold, otherwise child 1
+  ATTVAL *group;          ///< child of each value for grouping test ( NULL if not )
+  ATTVAL nr_group;        ///< the number of values in group array
 
 public:
   /// @name constructor
@@ -138,6 +147,43 @@ public:
   ///
   /// @retval the number of possible value
   ATTVAL getNrChild(void) const;
+
+  /// @brief getting the most common target value of training examples
+  ///
+  /// @retval target value used when this node is pruned to leaf
+  ATTVAL getMajor(void) const;
+
+  /// @brief checking if this node tests continuous attr with threshold
+  ///
+  /// @retval true if threshold test
+  bool isNumeric(void) const;
+
+  /// @brief getting threshold of continuous attr test
+  ///
+  /// @retval threshold
+  ATTVAL getThreshold(void) const;
+
+  /// @brief getting group array of grouping test
+  ///
+  /// @retval child of each value ( NULL if not grouping test )
+  const ATTVAL* getGroup(void) const;
+
+  /// @brief getting the number of values in group array
+  ///
+  /// @retval nr_group
+  ATTVAL getNrGroup(void) const;
+
+  /// @brief getting child index for attribute value
+  ///
+  /// @param val attribute value of tested attr
+  /// @retval child index ( val itself for nominal attr, -1 if no group )
+  ATTVAL getBranch(ATTVAL val) const {
+    if (numeric)
+      return (ATTVAL) (val > threshold);
+    if (group)
+      return ((unsigned) val < (unsigned) nr_group) ? group[val] : -1;
+    return val;
+  }
   /// @}
   
   /// @name Functional Attributes
@@ -163,6 +209,22 @@ public:
   ///
   /// @param nr_child the number of child branch
   void setNrChild(ATTVAL nr_child);
+
+  /// @brief setting the most common target value of training examples
+  ///
+  /// @param major target value used when this node is pruned to leaf
+  void setMajor(ATTVAL major);
+
+  /// @brief making this node binary threshold test on continuous attr
+  ///
+  /// @param threshold child 0 if value <= threshold, otherwise child 1
+  void setThreshold(ATTVAL threshold);
+
+  /// @brief making this node grouping test; each value goes to its child
+  ///
+  /// @param group child of each value ( owned by this node )
+  /// @param nr_group the number of values
+  void setGroup(ATTVAL *group, ATTVAL nr_group);
   /// @}
 };
 
@@ -294,6 +356,257 @@ public:
   ///
   /// @param nr_att the number of attr
   void setNrAtt(ATTINDEX nr_att);
+
+  /// @brief exporting tree as self-contained C++ source
+  /// @details the source defines extern "C" int predict(const int *att) @n
+  ///          as nested switches on attr index with leaves as constants, @n
+  ///          and extern "C" int nr_input(void) returning ( nr_att - 1 )
+  ///
+  /// @param out source output stream
+  void exportCode(std::ostream *out) const;
+  /// @}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief Flattened Decision Tree Class
+/// @details Compiled inference form of DTree. Nodes are laid out breadth @n
+///          first in one contiguous array of ( attr, link ) pairs, so the @n
+///          children of a node are adjacent. attr -1 marks leaf whose link @n
+///          is prediction value; otherwise link is the index of the first @n
+///          child. Threshold test on continuous attr is marked by attr @n
+///          ( -2 - attr ) and its threshold is kept in a side array. @n
+///          Grouping test is marked by ( -2 - nr_att - attr ), and side @n
+///          array keeps offset of its value-to-child map in group array. @n
+///          Pairs are 16-bit when tree and schema fit in short, @n
+///          otherwise 32-bit. Walking needs no virtual dispatch.
+///
+
+class FlatTree {
+private:
+  short     *node16;        ///< 16-bit ( attr, link ) pairs ( NULL if 32-bit is used )
+  int       *node32;        ///< 32-bit ( attr, link ) pairs ( NULL if 16-bit is used )
+  int       *thres;         ///< threshold or group offset of each node ( NULL if not used )
+  int       *groups;        ///< value-to-child maps of grouping tests ( NULL if none )
+  int       nr_groups;      ///< the number of entries in groups
+  int       nr_node;        ///< the number of nodes
+  ATTVAL    *attSizes;      ///< attribute size array ( not owned )
+  ATTINDEX  nr_att;         ///< the number of attributes including target attr
+  void      *map;           ///< mapped model file ( NULL if compiled from DTree )
+  size_t    map_size;       ///< the bytes of mapped model file
+
+  /// @brief default constructor for load()
+  FlatTree(void);
+
+public:
+  /// @name constructor
+  /// @{
+
+  /// @brief constructor compiling a decision tree
+  ///
+  /// @param tree decision tree which has root
+  FlatTree(DTree *tree);
+
+  /// @brief loading binary model file written by save()
+  /// @details file is mapped read-only and shared, so nodes are used in @n
+  ///          place and processes loading the same file share page cache
+  ///
+  /// @param path model file path
+  /// @retval flattened tree on mapped file
+  /// @retval NULL if file can't be mapped or is not a valid model
+  static FlatTree* load(const char *path);
+  /// @}
+
+  /// @name destructor
+  /// @{
+
+  /// @brief default destructor
+  ~FlatTree(void);
+  /// @}
+
+  /// @name informative attributes
+  /// @{
+
+  /// @brief getting the number of nodes
+  ///
+  /// @retval nr_node
+  int getNrNode(void) const;
+
+  /// @brief getting the bytes of node array
+  ///
+  /// @retval node array size in bytes
+  int getNrByte(void) const;
+
+  /// @brief getting the number of attr
+  ///
+  /// @retval nr_att
+  ATTINDEX getNrAtt(void) const;
+
+  /// @brief getting att size array
+  ///
+  /// @retval attribute size array ( owned by tree or model file )
+  const ATTVAL* getAttSizeArray(void) const;
+
+  /// @brief getting prediction value from path array
+  ///
+  /// @param attArray array of attr path
+  /// @retval prediction value
+  /// @retval -1 if attArray has invalid value on the path
+  ATTVAL getVal(const ATTVAL *attArray) const;
+
+  /// @brief getting prediction values of many path arrays
+  /// @details instances are walked in interleaved lanes, one level per @n
+  ///          lane at a time, so node loads of different instances overlap
+  ///
+  /// @param rows row-major path arrays ( n rows of stride values )
+  /// @param stride the number of values per row
+  /// @param n the number of rows
+  /// @param out prediction values ( -1 for invalid row )
+  void getValBatch(const ATTVAL *rows, int stride, size_t n, ATTVAL *out) const;
+  /// @}
+
+  /// @name functional attributes
+  /// @{
+
+  /// @brief saving binary model file
+  /// @details versioned header ( magic, version, nr_att, nr_node, node @n
+  ///          width, side array flag, group size ), attribute size @n
+  ///          array, node array, side array ( if flag is set ) and group @n
+  ///          array follow in native byte order
+  ///
+  /// @param path model file path
+  /// @retval true if saving succeeds
+  /// @retval false if file can't be written
+  bool save(const char *path) const;
+  /// @}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief Column-Oriented Data Set Class
+/// @details Examples are stored as structure of arrays; one contiguous @n
+///          array per attribute (including target attr). Counting routines @n
+///          scan a column linearly instead of chasing one row pointer per @n
+///          example. A subset of examples is represented by row indices. @n
+///          Values are kept as narrow as attr sizes allow: 8 bits if every @n
+///          attr is nominal of at most 256 values, 16 bits up to 65536, @n
+///          32 bits otherwise ( continuous attrs take any value ).
+///
+
+class DataSet {
+private:
+  unsigned char  *data8;    ///< 8-bit column-major values ( NULL unless width is 1 )
+  unsigned short *data16;   ///< 16-bit column-major values ( NULL unless width is 2 )
+  ATTVAL    *data32;        ///< 32-bit column-major values ( NULL unless width is 4 )
+  int       width;          ///< bytes per value
+  ATTINDEX  nr_att;         ///< the number of attributes including target attr
+  int       nr_row;         ///< the number of examples
+  int       nr_word;        ///< 64-bit words per bitmap ( 0 if index is not made )
+  int       nr_valbit;      ///< the number of ( attr, value ) bitmaps
+  int       *bitOffset;     ///< first bitmap of each attr ( -1 if not indexed )
+  unsigned long long *valBits;    ///< ( attr, value ) bitmaps, word-major ( nr_valbit words per row word )
+  unsigned long long *classBits;  ///< class bitmaps, word-major ( class size words per row word )
+
+public:
+  /// @name constructor
+  /// @{
+
+  /// @brief constructor taking data set size
+  ///
+  /// @param nr_att the number of attributes including target attr
+  /// @param nr_row the number of examples
+  /// @param attSizes attributes sizes array choosing value width ( NULL for 32 bits )
+  DataSet(ATTINDEX nr_att, int nr_row, const ATTVAL *attSizes = NULL);
+  /// @}
+
+  /// @name destructor
+  /// @{
+
+  /// @brief default destructor
+  ~DataSet(void);
+  /// @}
+
+  /// @name informative attributes
+  /// @{
+
+  /// @brief getting the number of attr
+  ///
+  /// @retval nr_att
+  ATTINDEX getNrAtt(void) const;
+
+  /// @brief getting the number of examples
+  ///
+  /// @retval nr_row
+  int getNrRow(void) const;
+
+  /// @brief getting bytes per value
+  ///
+  /// @retval 1 ( unsigned char ), 2 ( unsigned short ) or 4 ( ATTVAL )
+  int getWidth(void) const;
+
+  /// @brief getting one attribute column
+  ///
+  /// @param att attribute index
+  /// @retval contiguous array of nr_row values of getWidth() bytes
+  const void* getColumn(ATTINDEX att) const;
+
+  /// @brief getting one value
+  ///
+  /// @param row example index
+  /// @param att attribute index
+  /// @retval attribute value of the example
+  ATTVAL getVal(int row, ATTINDEX att) const;
+
+  /// @brief checking if bitmap index is made
+  ///
+  /// @retval true if makeBitmap() made index
+  bool hasBitmap(void) const;
+
+  /// @brief getting first bitmap of attr in a row word
+  ///
+  /// @param att attribute index
+  /// @retval offset of bitmap of value 0 ( -1 if attr is not indexed )
+  int getBitOffset(ATTINDEX att) const;
+
+  /// @brief getting the number of ( attr, value ) bitmaps
+  ///
+  /// @retval nr_valbit
+  int getNrValBit(void) const;
+
+  /// @brief getting ( attr, value ) bitmaps
+  /// @details bit ( r & 63 ) of word ( r >> 6 ) * nr_valbit + offset + v @n
+  ///          is set if row r has value v at attr of offset
+  ///
+  /// @retval word-major bitmaps ( NULL if index is not made )
+  const unsigned long long* getValBits(void) const;
+
+  /// @brief getting class bitmaps
+  /// @details bit ( r & 63 ) of word ( r >> 6 ) * nr_class + c is set if @n
+  ///          row r has class c
+  ///
+  /// @retval word-major bitmaps ( NULL if index is not made )
+  const unsigned long long* getClassBits(void) const;
+  /// @}
+
+  /// @name functional attributes
+  /// @{
+
+  /// @brief setting one value
+  ///
+  /// @param row example index
+  /// @param att attribute index
+  /// @param val new attribute value ( it must fit in value width )
+  void setVal(int row, ATTINDEX att, ATTVAL val);
+
+  /// @brief making bitmap index of small-domain attrs and classes
+  /// @details nominal attr of at most 64 values gets one bitmap per @n
+  ///          value, and target attr one per class; index is made once @n
+  ///          and shared by every tree on this data set, so it must be @n
+  ///          made before trees are trained concurrently. Values must not @n
+  ///          change after it is made
+  ///
+  /// @param attSizes attributes sizes array
+  void makeBitmap(const ATTVAL *attSizes);
   /// @}
 };
 
@@ -301,80 +614,396 @@ public:
 ///
 /// @brief ID3 Algorithm Engine
 /// @details ID3 algorithm is most basic form of decision tree learning. @n
-///          It uses DTree
+///          It uses DTree. Attribute of size 0 is continuous; it is @n
+///          split in two by the best threshold C4.5-style, and can be @n
+///          tested again below. Continuous values are signed integers, @n
+///          so real values must be scaled to integers beforehand.
 ///
 
+struct BestNode;
+
 class ID3 {
 private:
   DTree *dtree;         ///< a decision tree used for ID3
   ATTVAL *attSizes;     ///< attribute size information array including target attr
   ATTINDEX nr_att;      ///< the number of attributes including target attribute
-  ATTVAL **train;       ///< two dimension array of training data set
-  ATTVAL **valid;       ///< two dimension array of validation data set
-  int nr_train;         ///< the number of training data
-  int nr_valid;         ///< the number of validation data
+  DataSet *train;       ///< column-oriented training data set
+  DataSet *valid;       ///< column-oriented validation data set
+  int *tableOffset;     ///< offset of each attr in count table ( attr x value x class )
+  int tableSize;        ///< the number of entries in count table
+  int *rowIndex;        ///< training row indices shared by tree building ( partitioned in place )
+  int *rowScratch;      ///< scratch buffer for partitioning rowIndex
+  int **sortedRows;     ///< presorted row indices of each swept continuous attr ( partitioned like rowIndex )
+  int nr_bin;           ///< the maximum number of bins in histogram mode ( 0 if not )
+  ATTVAL *nrBins;       ///< the number of bins of each binned attr ( 0 if not binned )
+  ATTVAL **binCol;      ///< bin of each training row for binned attr ( NULL if not binned )
+  ATTVAL **binMap;      ///< bin of each value for binned nominal attr ( NULL if not )
+  ATTVAL **binEdge;     ///< the largest value of each bin for binned continuous attr ( NULL if not )
+  ATTVAL trainMajor;    ///< the most common target value of training set
+  FlatTree *flat;       ///< flattened dtree for prediction ( NULL until makeTree )
+  int nr_thread;        ///< the number of threads of pool ( 0 means the number of cores )
+  WorkPool *pool;       ///< thread pool for parallel tree building ( NULL until first use )
+  bool member;          ///< true if ensemble member ( train, attSizes and pool are shared )
+  int *sample;          ///< training row indices, may repeat ( NULL means all rows )
+  int nr_sample;        ///< the number of entries in sample
+  int nr_cand;          ///< the number of attrs drawn at each node ( 0 means all )
+  unsigned seed;        ///< random seed of root node
+  double *weight;       ///< weight of each training row ( NULL means unit weight )
+  int maxDepth;         ///< the maximum depth of tree ( 0 means no limit )
+  bool levelWise;       ///< true if tree is made level by level ( breadth first )
+  double chiLevel;      ///< significance level of chi-square split test ( 0 means no test )
+  int minRows;          ///< the minimum number of rows to split a node ( 0 means no limit )
+  int maxNodes;         ///< node budget of best-first growth ( 0 means no limit )
+  int timeBudget;       ///< growing time budget of best-first growth in msec ( 0 means no limit )
+  bool bitmap;          ///< true if small-domain attrs may be counted by bitmap index
+  bool useBits;         ///< true if rows of current training are counted by bitmap index
   
   /// @name help private attributes
   /// @{
 
-  /// @brief counting given attribute combination in training set
+  /// @brief setting every attribute to its default shared by constructors
+  void init(void);
+
+  /// @brief laying out count table ( tableOffset and tableSize ) by attSizes
+  void layoutTable(void);
+
+  /// @brief getting thread pool, starting it on first use
+  ///
+  /// @retval thread pool of nr_thread threads ( ensemble's one for member )
+  WorkPool* getPool(void);
+
+  /// @brief making contingency count table in a single pass
+  /// @details count table entry ( tableOffset[att] + val * nr_class + class ) @n
+  ///          is the number ( or weight sum ) of examples having value val @n
+  ///          at att and class; val is the bin for binned attr
   ///
-  /// @param att_array attribute combination ( ATTVAL -1 is recognized as dontcare )
-  /// @param examples given examples
+  /// @param remainAtt remaining attr displaying array ( only these are counted )
+  /// @param rows given example row indices of training set
   /// @param nr_ex the number of examples
-  /// @retval counting number
-  int countInstance(ATTVAL *att_array, ATTVAL **examples, int nr_ex);
-  
-  /// @brief calculating entropy
+  /// @param table count table to be filled ( tableSize entries )
+  /// @param class_cnt class count array to be filled ( target attr size entries )
+  void countTable(bool *remainAtt, int *rows, int nr_ex, double *table,
+    double *class_cnt);
+
+  /// @brief counting ( value x class ) table of one attribute column
   ///
-  /// @param examples given examples
+  /// @param att the index of attribute
+  /// @param rows given example row indices of training set
+  /// @param nr_ex the number of examples
+  /// @param att_table attribute part of count table ( accumulated, not cleared )
+  void countColumn(ATTINDEX att, int *rows, int nr_ex, double *att_table);
+
+  /// @brief countColumn() task for WorkPool
+  ///
+  /// @param arg count task argument
+  static void countTask(void *arg);
+
+  /// @brief counting classes of given examples
+  ///
+  /// @param rows given example row indices of training set
   /// @param nr_ex the number of examples
-  /// @retval entropy for given examples with target attr
-  double calEntropy(ATTVAL **examples, int nr_ex);
+  /// @param class_cnt class count array to be filled ( target attr size entries )
+  void countClass(int *rows, int nr_ex, double *class_cnt);
+
+  /// @brief checking if attr is counted by bitmap index of training set
+  ///
+  /// @param att attribute index
+  /// @retval true if attr has bitmaps and is not binned
+  bool indexed(ATTINDEX att) const;
+
+  /// @brief counting indexed attrs of node by AND and popcount
+  /// @details node bitmap words are gathered from ascending rows in one @n
+  ///          pass, and count of ( value, class ) is popcount of @n
+  ///          node & value & class bits, 64 rows at a time. Index is used @n
+  ///          only if that costs less than scanning the columns
+  ///
+  /// @param remainAtt remaining attr displaying array
+  /// @param rows given example row indices of training set ( ascending )
+  /// @param nr_ex the number of examples
+  /// @param table count table counts are added to
+  /// @retval true if every remaining indexed attr is counted
+  bool countBitmap(bool *remainAtt, int *rows, int nr_ex, double *table);
+
+  /// @brief counting indexed attrs on some node bitmap words
+  ///
+  /// @param node node bitmap words
+  /// @param word row word index of each node word
+  /// @param n the number of node words
+  /// @param att indexed attrs to count
+  /// @param nr_idx the number of attrs in att
+  /// @param cnt count table counts are added to ( tableSize entries )
+  void countWords(const unsigned long long *node, const int *word, int n,
+    const ATTINDEX *att, int nr_idx, int *cnt);
+
+  /// @brief countWords() task for WorkPool
+  ///
+  /// @param arg bitmap count task argument
+  static void wordTask(void *arg);
+
+  /// @brief calculating entropy
+  ///
+  /// @param class_cnt class count ( or weight sum ) array
+  /// @param nr_ex the number ( or weight sum ) of examples
+  /// @retval entropy for given class distribution
+  double calEntropy(double *class_cnt, double nr_ex);
 
   /// @brief calculating Gain value
   ///
   /// @param att attribute which is wanted to test
-  /// @param examples given examples
-  /// @param nr_ex the number of examples
+  /// @param table count table made by countTable()
+  /// @param class_cnt class count array made by countTable()
+  /// @param nr_ex the number ( or weight sum ) of examples
   /// @retval gain value
-  double calGain(ATTINDEX att, ATTVAL **examples, int nr_ex);
+  double calGain(ATTINDEX att, double *table, double *class_cnt, double nr_ex);
+
+  /// @brief finding best binary split of binned attr
+  /// @details bins are ordered ( by value, or by target rate for nominal @n
+  ///          attr ), so only nrBins - 1 prefixes of bins are candidates
+  ///
+  /// @param att the index of binned attribute
+  /// @param table count table made by countTable()
+  /// @param class_cnt class count array made by countTable()
+  /// @param nr_ex the number ( or weight sum ) of examples
+  /// @param gain best gain ( unchanged if no split )
+  /// @param cut the last bin of first child ( unchanged if no split )
+  /// @retval true if both children of some split have examples
+  bool binGain(ATTINDEX att, double *table, double *class_cnt, double nr_ex,
+    double &gain, ATTVAL &cut);
+
+  /// @brief quantizing attrs into at most nr_bin bins of similar row counts
+  /// @details continuous attrs are binned by value, and nominal attrs having @n
+  ///          more than nr_bin values are binned in order of the rate of @n
+  ///          the most common target value; count table is laid out again
+  void makeBins(void);
+
+  /// @brief freeing bins made by makeBins()
+  void freeBins(void);
   
+  /// @brief finding best threshold of continuous attr
+  /// @details linear sweep over presorted rows; every boundary between @n
+  ///          different values is a candidate of binary split
+  ///
+  /// @param att the index of continuous attribute
+  /// @param begin the first position of current examples
+  /// @param end the next position of the last current example
+  /// @param class_cnt class count array of current examples
+  /// @param gain best gain ( unchanged if no boundary )
+  /// @param threshold best threshold ( unchanged if no boundary )
+  /// @retval true if there is a boundary
+  bool sweepColumn(ATTINDEX att, int begin, int end, double *class_cnt,
+    double &gain, ATTVAL &threshold);
+
+  /// @brief sweepColumn() task for WorkPool
+  ///
+  /// @param arg sweep task argument
+  static void sweepTask(void *arg);
+
   /// @brief taking best attribute with Gain function
   ///
   /// @param remainAtt remaining attr displaying array ( 1 means remain, 0 means used )
-  /// @param example given examples
+  /// @param begin the first position of current examples in rowIndex
+  /// @param end the next position of the last current example in rowIndex
+  /// @param table count table made by countTable() ( class counts follow )
+  /// @param threshold threshold if best attr is continuous, or the last bin @n
+  ///                  of first child if best attr is binned nominal attr
+  /// @param gain Gain of best attr ( not filled if NULL )
+  /// @retval best attr index ( -1 if no attr can split examples )
+  ATTINDEX takeBestAtt(bool *remainAtt, int begin, int end, double *table,
+    ATTVAL &threshold, double *gain = NULL);
+
+  /// @brief drawing nr_cand remaining attrs at random
+  ///
+  /// @param remainAtt remaining attr displaying array
+  /// @param state random state of current node ( advanced )
+  /// @retval new candidate flags array ( NULL if every remaining attr is drawn )
+  bool* drawAtt(bool *remainAtt, unsigned &state);
+
+  /// @brief the most common ( or the heaviest ) target value of given examples
+  ///
+  /// @param rows given example row indices of training set
   /// @param nr_ex the number of examples
-  /// @retval best attr index
-  ATTINDEX takeBestAtt(bool *remainAtt, ATTVAL **examples, int nr_ex);
+  /// @retval the most common target value ( -1 if no example )
+  ATTVAL majorClass(int *rows, int nr_ex);
 
-  /// @brief making new example data set
+  /// @brief partitioning row index range in place by child of node
+  /// @details counting sort through scratch; row order is kept @n
+  ///          in each child range, so presorted rows stay sorted
   ///
-  /// @param src source example data set
-  /// @param nr_src the number of source data
-  /// @param att the index of attribute
-  /// @param val the value of this attribute
-  /// @param dst destination example data array pointer
-  /// @retval the number of destination data
-  ATTVAL** makeNewExam(ATTVAL **src, int nr_src, ATTINDEX att, ATTVAL val, int &nr_dst);
-  
+  /// @param set data set which rows belong to
+  /// @param rows row index array ( rowIndex for training set )
+  /// @param scratch scratch array as large as rows
+  /// @param node node whose test decides child of each row
+  /// @param begin the first position of range in rows
+  /// @param end the next position of the last one in range
+  /// @param child_begin child range start array ( node children + 1 entries )
+  void partition(DataSet *set, int *rows, int *scratch, DTreeRoot *node,
+    int begin, int end, int *child_begin);
+
+  /// @brief the leaf value of node needing no split
+  /// @details empty node gets the most common value of training set, and @n
+  ///          pure, exhausted, deep enough or too small node gets its own
+  ///
+  /// @param remainAtt remain attribute flags of node
+  /// @param begin the first position of node examples in rowIndex
+  /// @param end the next position of the last node example in rowIndex
+  /// @param depth depth of node
+  /// @retval leaf value ( -1 if node should be split )
+  ATTVAL leafValue(bool *remainAtt, int begin, int end, int depth);
+
+  /// @brief taking best attr among drawn candidates ( or all remaining )
+  ///
+  /// @param remainAtt remain attribute flags of node
+  /// @param begin the first position of node examples in rowIndex
+  /// @param end the next position of the last node example in rowIndex
+  /// @param table count table of node examples ( class counts follow )
+  /// @param seed random state of node ( advanced )
+  /// @param threshold threshold ( or the last bin of first child ) of best attr
+  /// @param gain Gain of best attr ( not filled if NULL )
+  /// @retval best attr index ( -1 if no attr can split examples )
+  ATTINDEX chooseAtt(bool *remainAtt, int begin, int end, double *table,
+    unsigned &seed, ATTVAL &threshold, double *gain = NULL);
+
+  /// @brief making leaf or test node for node examples
+  ///
+  /// @param leaf_val leaf value ( -1 for the most common value of examples )
+  /// @param best test attr ( -1 for leaf )
+  /// @param threshold threshold ( or the last bin of first child ) of best attr
+  /// @param begin the first position of node examples in rowIndex
+  /// @param end the next position of the last node example in rowIndex
+  /// @retval new node ( children of test node are not made )
+  DTreeNode* makeNode(ATTVAL leaf_val, ATTINDEX best, ATTVAL threshold,
+    int begin, int end);
+
+  /// @brief chi-square test of test node on node examples
+  /// @details contingency table is ( child x class ); weighted rows are @n
+  ///          rescaled to sum to the number of rows. Split is kept only if @n
+  ///          independence of child and class is rejected at chiLevel.
+  ///
+  /// @param node test node made for examples
+  /// @param begin the first position of node examples in rowIndex
+  /// @param end the next position of the last node example in rowIndex
+  /// @retval true if split is significant ( always if no test )
+  bool significant(DTreeRoot *node, int begin, int end);
+
+  /// @brief making node by makeNode(), pre-pruned by significant()
+  /// @details the same node for every builder; split failing the test @n
+  ///          is deleted and made leaf
+  ///
+  /// @param leaf_val leaf value ( -1 for the most common value of examples )
+  /// @param best test attr ( -1 for leaf ); set to -1 if pre-pruned
+  /// @param threshold threshold ( or the last bin of first child ) of best attr
+  /// @param begin the first position of node examples in rowIndex
+  /// @param end the next position of the last node example in rowIndex
+  /// @retval new node ( children of test node are not made )
+  DTreeNode* makeTestedNode(ATTVAL leaf_val, ATTINDEX &best, ATTVAL threshold,
+    int begin, int end);
+
+  /// @brief hanging node off parent ( or tree for root )
+  ///
+  /// @param parent parent node ( NULL for root )
+  /// @param ch_index child index in parent
+  /// @param tree master tree ( only for root )
+  /// @param cur node to hang
+  void attachNode(DTreeRoot *parent, int ch_index, DTree *tree, DTreeNode *cur);
+
   /// @brief recursively making tree function
+  /// @details children having enough rows are built as WorkPool tasks. @n
+  ///          For binary split, only the smaller child is counted, and the @n
+  ///          larger one gets parent count table minus its sibling's
   ///
   /// @param parent current parent DTreeRoot
-  /// @param cur current DTreeNode
+  /// @param ch_index index for child number of parent
+  /// @param tree master tree ( only for root )
   /// @param remainAtt current remain attribute flags array (except for target attr)
-  /// @param cur_ex current test examples
-  /// @param nr_cur_ex the number of current test examples
+  /// @param begin the first position of current examples in rowIndex
+  /// @param end the next position of the last current example in rowIndex
+  /// @param table count table of current examples ( owned; NULL if not counted )
+  /// @param seed random seed of current node ( children get theirs from it )
+  /// @param depth depth of current node ( 0 for root )
   void recursive_make_tree(DTreeRoot *parent, int ch_index, DTree *tree,
-    bool *remainAtt, ATTVAL **cur_ex, int nr_cur_ex, int indent, bool first, bool last); 
+    bool *remainAtt, int begin, int end, double *table, unsigned seed, int depth); 
+
+  /// @brief recursive_make_tree() task for WorkPool
+  ///
+  /// @param arg subtree task argument
+  static void buildTask(void *arg);
+
+  /// @brief counting one column into count tables of frontier nodes
+  /// @details every position in range having a slot is counted in the @n
+  ///          table of its slot; slots of a column sweep don't overlap @n
+  ///          other columns, so columns can be counted concurrently
+  ///
+  /// @param att the index of attribute ( target attr counts classes )
+  /// @param slot count table slot of each rowIndex position ( -1 if not counted )
+  /// @param begin the first position of range in rowIndex
+  /// @param end the next position of the last one in range
+  /// @param tables count tables of frontier, one per slot ( class counts follow each )
+  void countLevel(ATTINDEX att, int *slot, int begin, int end, double *tables);
+
+  /// @brief countLevel() task for WorkPool
+  ///
+  /// @param arg level count task argument
+  static void levelTask(void *arg);
+
+  /// @brief making tree level by level ( breadth first )
+  /// @details each depth sweeps the rows of its frontier once per column, @n
+  ///          counting all frontier nodes together, so data passes per tree @n
+  ///          are as many as depth; nodes are the same as @n
+  ///          recursive_make_tree() makes
+  ///
+  /// @param remainAtt remain attribute flags of root
+  void level_make_tree(bool *remainAtt);
+
+  /// @brief making provisional leaf of queued node and its best split
+  /// @details node needing no split gets its final leaf; otherwise the @n
+  ///          majority leaf stands in for it until it is expanded, and its @n
+  ///          test node and priority ( Gain x rows ) are filled in
+  ///
+  /// @param b queued node ( remainAtt is freed if it gets final leaf )
+  /// @retval true if node can be expanded later
+  bool openBest(BestNode *b);
+
+  /// @brief making tree best first under node and time budgets
+  /// @details the open node of the highest Gain x rows is expanded first; @n
+  ///          when a budget runs out, open nodes stay majority leaves, so @n
+  ///          the tree made so far is a whole tree ( anytime ). Without @n
+  ///          budget, nodes are the same as recursive_make_tree() makes
+  ///
+  /// @param remainAtt remain attribute flags of root
+  void best_make_tree(bool *remainAtt);
+
+  /// @brief recursively printing tree to standard output
+  ///
+  /// @param cur current DTreeNode
+  /// @param indent indentation for standard output
+  /// @param first flag for whether current node is first child of parent
+  /// @param last flag for whether current node is last child of parent
+  void recursive_print_tree(DTreeNode *cur, int indent, bool first, bool last);
   
-  /// @brief recursively pruning tree function
+  /// @brief recursively pruning tree function ( reduced error pruning )
+  /// @details validation rows are routed down by partitioning them once per @n
+  ///          level; children are pruned first, then the node is replaced @n
+  ///          with its training majority leaf if that makes no more errors @n
+  ///          on validation rows reaching it than its ( pruned ) subtree
   ///
   /// @param cur current DTreeNode
-  /// @param path attribution combination (used for countInstance())
-  /// @param valid validation examples set
-  /// @param nr_valid the number of validation set
-  void recursive_prune_tree(DTreeNode *cur, ATTVAL *path, ATTVAL **valid, int nr_valid);
+  /// @param rows validation row index array
+  /// @param scratch scratch array as large as rows
+  /// @param begin the first position of validation rows reaching cur
+  /// @param end the next position of the last one
+  /// @param nr_error the number of validation errors of returned node
+  /// @param nr_pruned the number of pruned subtrees ( accumulated )
+  /// @retval cur itself, or new leaf replacing cur ( cur is freed )
+  DTreeNode* recursive_prune_tree(DTreeNode *cur, int *rows, int *scratch,
+    int begin, int end, int &nr_error, int &nr_pruned);
+
+  /// @brief rebuilding flattened dtree after dtree changes
+  void compile(void);
+
+  /// @brief predictBatch() task for WorkPool
+  ///
+  /// @param arg prediction task argument
+  static void predictTask(void *arg);
   /// @}
 
 public:
@@ -385,12 +1014,29 @@ public:
   ///
   /// @param attSizes attributes sizes array
   /// @param nr_att the number of attributes
-  /// @param train training data array ( n x nr_train )
+  /// @param train training data set
   /// @param valid validation data set
-  /// @param nr_train the number of training data
-  /// @param nr_valid the number of validataion data
-  ID3(ATTVAL *attSizes, ATTINDEX nr_att, ATTVAL **train, 
-      ATTVAL **valid, int nr_train, int nr_valid);
+  ID3(ATTVAL *attSizes, ATTINDEX nr_att, DataSet *train, DataSet *valid);
+
+  /// @brief constructor taking loaded model ( prediction only )
+  ///
+  /// @param flat flattened tree loaded by FlatTree::load()
+  ID3(FlatTree *flat);
+
+  /// @brief constructor taking tree made elsewhere ( prediction only )
+  ///
+  /// @param tree decision tree which has root ( owned )
+  ID3(DTree *tree);
+
+  /// @brief constructor for ensemble member sharing data
+  /// @details train, attSizes and pool are not owned, and tree is not @n
+  ///          printed while making; there is no validation set
+  ///
+  /// @param attSizes attributes sizes array
+  /// @param nr_att the number of attributes
+  /// @param train training data set
+  /// @param pool thread pool of ensemble
+  ID3(ATTVAL *attSizes, ATTINDEX nr_att, DataSet *train, WorkPool *pool);
   /// @}
 
   /// @name destructor
@@ -406,7 +1052,7 @@ public:
   /// @brief making decision tree
   void makeTree(void);
 
-  /// @brief reduced error tree pruning
+  /// @brief reduced error tree pruning with validation set
   void prune(void); 
 
   /// @brief predict for new unknown instance
@@ -414,6 +1060,109 @@ public:
   /// @param input new unknown input
   /// @retval target attribute value predicted
   ATTVAL predict(ATTVAL *input);
+
+  /// @brief predict for many new unknown instances
+  /// @details large input is split into row blocks predicted by WorkPool
+  ///
+  /// @param rows row-major instances ( n rows of ( nr_att - 1 ) values )
+  /// @param n the number of instances
+  /// @param out target attribute values predicted ( n entries )
+  void predictBatch(const ATTVAL *rows, size_t n, ATTVAL *out);
+
+  /// @brief getting decision tree
+  ///
+  /// @retval dtree ( NULL for loaded model )
+  DTree* getTree(void) const;
+
+  /// @brief getting the number of nodes of trained or loaded tree
+  ///
+  /// @retval the number of nodes ( 0 before makeTree )
+  int getNrNode(void) const;
+
+  /// @brief saving trained model as binary model file
+  ///
+  /// @param path model file path
+  /// @retval true if saving succeeds
+  /// @retval false if saving fails
+  bool save(const char *path) const;
+
+  /// @brief setting the number of threads for tree building
+  ///
+  /// @param nr_thread the number of threads ( 0 means the number of cores )
+  void setNrThread(int nr_thread);
+
+  /// @brief setting histogram mode for makeTree()
+  /// @details binned attrs are split in two by a prefix of their bins, @n
+  ///          so the number of children no longer grows with cardinality
+  ///
+  /// @param nr_bin the maximum number of bins per attr ( 0 turns it off )
+  void setNrBin(int nr_bin);
+
+  /// @brief setting training rows for makeTree()
+  ///
+  /// @param sample row indices of training set, may repeat ( not owned )
+  /// @param nr_sample the number of row indices
+  void setSample(int *sample, int nr_sample);
+
+  /// @brief setting random attr subset for makeTree()
+  /// @details best attr of each node is taken among nr_cand remaining @n
+  ///          attrs drawn at random ( among all remaining if none splits )
+  ///
+  /// @param nr_cand the number of attrs drawn at each node ( 0 means all )
+  /// @param seed random seed of root node
+  void setNrCand(int nr_cand, unsigned seed);
+
+  /// @brief setting instance weights for makeTree()
+  /// @details counts, gains and majority values are weighted; weights @n
+  ///          must be positive
+  ///
+  /// @param weight weight of each training row ( not owned; NULL for unit )
+  void setWeight(double *weight);
+
+  /// @brief setting level-wise ( breadth first ) building for makeTree()
+  ///
+  /// @param levelWise true for level by level, false for depth first
+  void setLevelWise(bool levelWise);
+
+  /// @brief setting the maximum depth for makeTree()
+  ///
+  /// @param maxDepth the maximum depth of tree ( 0 means no limit )
+  void setMaxDepth(int maxDepth);
+
+  /// @brief setting chi-square pre-pruning for makeTree()
+  /// @details a split whose child and class look independent at given @n
+  ///          significance level is not made; node becomes leaf instead
+  ///
+  /// @param chiLevel significance level ( 0 means no test )
+  void setSignificance(double chiLevel);
+
+  /// @brief setting the minimum number of rows to split a node
+  ///
+  /// @param minRows the minimum number of rows ( 0 means no limit )
+  void setMinRows(int minRows);
+
+  /// @brief setting budgets of best-first growth for makeTree()
+  /// @details any budget makes tree grow best first instead of depth or @n
+  ///          breadth first
+  ///
+  /// @param maxNodes the maximum number of tree nodes ( 0 means no limit )
+  /// @param timeBudget growing time budget in msec ( 0 means no limit )
+  void setBudget(int maxNodes, int timeBudget);
+
+  /// @brief setting bitmap index counting for makeTree()
+  /// @details bitmap index of training set is made for tree owning it; @n
+  ///          ensemble member uses index only if its owner made it. @n
+  ///          Weighted, repeated or unordered rows are counted as usual
+  ///
+  /// @param bitmap true to count by bitmap index where it is cheaper
+  void setBitmap(bool bitmap);
+
+  /// @brief checking if this CPU counts bits in hardware
+  /// @details software popcount never beats a row scan, so bitmap index @n
+  ///          is neither made nor used without it
+  ///
+  /// @retval true if bitmap index counting can be used
+  static bool bitmapSupported(void);
   /// @}
 };
 
@@ -0,0 +1,232 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file disk.h
+/// @brief Out-of-core Decision Tree Library Header File
+/// @details ID3 for training files larger than memory. Rows are never @n
+///          loaded; the tree grows level by level, and each depth makes @n
+///          one sequential pass over the text training file, routing every @n
+///          row down the tree built so far and counting it in the table of @n
+///          the frontier node it reaches. Memory is bounded by frontier @n
+///          size x count table size; a frontier larger than the table @n
+///          limit takes several passes.
+///
+/// @section reference_section Reference
+/// MACHINE LEARNING - TOM M. MITCHELL
+/// SLIQ: A FAST SCALABLE CLASSIFIER FOR DATA MINING - MANISH MEHTA, RAKESH
+/// AGRAWAL, JORMA RISSANEN
+///
+/// @section purpose_section Purpose
+/// Application trial for personal studying
+///
+
+#ifndef __DISKTREE__
+#define __DISKTREE__
+
+#include <iostream>
+#include "decision.h"
+
+struct DiskNode;
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief Out-of-core ID3 Class
+/// @details Nominal attr splits into all of its values as ID3 does. @n
+///          Continuous attr is quantized by bin edges taken from a row @n
+///          sample in the first pass, and split in two at a bin edge. @n
+///          The first quarter of rows is held out, and reduced error @n
+///          pruning makes one more pass over it.
+///
+
+class DiskID3 {
+private:
+  ATTVAL        *attSizes;    ///< attribute size information array including target attr ( NULL once taken )
+  ATTINDEX      nr_att;       ///< the number of attributes including target attribute
+  std::istream  *file;        ///< training text file positioned at the first row ( not owned )
+  std::streampos start;       ///< file position of the first row
+  std::streampos trainStart;  ///< file position of the first training row ( after validation rows )
+  int           nr_row;       ///< the number of rows in file
+  int           nr_valid;     ///< the number of leading rows held out for pruning
+  int           nr_bin;       ///< the maximum number of bins of continuous attr
+  int           maxDepth;     ///< the maximum depth of tree ( 0 means no limit )
+  int           minRows;      ///< the minimum number of rows to split a node ( 0 means no limit )
+  ATTVAL        *nrBins;      ///< the number of bins of each continuous attr ( 0 for nominal )
+  ATTVAL        **binEdge;    ///< the largest value of each bin ( NULL for nominal )
+  int           *tableOffset; ///< offset of each attr in count table ( attr x value x class )
+  int           tableSize;    ///< the number of entries in count table ( class counts follow )
+  DiskNode      *node;        ///< nodes in creation order; children of a node are adjacent
+  int           nr_node;      ///< the number of nodes
+  int           max_node;     ///< capacity of node array
+  ATTVAL        trainMajor;   ///< the most common target value of training rows
+  int           nr_pass;      ///< the number of passes over file
+  int           cur_row;      ///< row number of the next row to read ( from the first row )
+  int           bad_row;      ///< the first malformed or out-of-range row ( -1 if none )
+
+  char          *buf;         ///< read buffer
+  int           buf_pos;      ///< the next byte to parse in buffer
+  int           buf_len;      ///< the number of bytes in buffer
+  std::streampos buf_start;   ///< file position of the first byte in buffer
+
+  /// @name help private attributes
+  /// @{
+
+  /// @brief starting a pass at given file position
+  ///
+  /// @param pos file position of the first row to read
+  /// @param row row number of the first row to read
+  void rewind(std::streampos pos, int row);
+
+  /// @brief reading one row of the current pass
+  /// @details value is an integer, negative only for continuous attr, @n
+  ///          and nominal value must be less than attr size
+  ///
+  /// @param row values read ( nr_att entries )
+  /// @retval false if file ends before row is complete, or row is @n
+  ///         malformed or out of range ( bad_row is set )
+  bool readRow(ATTVAL *row);
+
+  /// @brief file position of the next row to read
+  ///
+  /// @retval file position
+  std::streampos tell(void) const;
+
+  /// @brief taking bin edges of continuous attrs from a row sample
+  /// @details the first pass; it also finds where training rows begin
+  ///
+  /// @retval false if a bad row is read
+  bool makeBins(void);
+
+  /// @brief the value of attr which count table is indexed by
+  ///
+  /// @param att attribute index
+  /// @param val attribute value
+  /// @retval val for nominal attr, bin of val for continuous attr
+  ATTVAL binOf(ATTINDEX att, ATTVAL val) const;
+
+  /// @brief appending a node
+  ///
+  /// @retval index of new node
+  int newNode(void);
+
+  /// @brief routing a row down the tree made so far
+  ///
+  /// @param row row values
+  /// @retval index of leaf or frontier node reached ( or of the node no @n
+  ///         child of which takes the value )
+  int route(const ATTVAL *row) const;
+
+  /// @brief child of a test node which a row goes to
+  ///
+  /// @param n test node
+  /// @param row row values
+  /// @retval child number ( -1 if no child takes the value )
+  int childOf(const DiskNode *n, const ATTVAL *row) const;
+
+  /// @brief making a child node from its class counts
+  /// @details empty, pure, exhausted, deep enough or too small child @n
+  ///          becomes leaf at once; @n
+  ///          otherwise it joins the next frontier
+  ///
+  /// @param index child node index
+  /// @param class_cnt class counts of rows reaching child
+  /// @param remain remaining attr flags of child ( owned; freed if leaf )
+  /// @param depth depth of child
+  /// @retval true if child joins the next frontier
+  bool makeChild(int index, int *class_cnt, bool *remain, int depth);
+
+  /// @brief splitting a frontier node by its count table
+  /// @details best attr is taken by Gain in attribute order as ID3 does
+  ///
+  /// @param index frontier node index
+  /// @param table count table of node ( class counts follow )
+  /// @param next next frontier ( children joining it are appended )
+  /// @param nr_next the number of nodes in next frontier
+  /// @param depth depth of node
+  void split(int index, int *table, int *next, int &nr_next, int depth);
+
+  /// @brief recursively building DTree from node array
+  ///
+  /// @param index node index
+  /// @retval decision tree node
+  DTreeNode* build(int index) const;
+
+  /// @brief the number of nodes reachable from given node
+  ///
+  /// @param index node index
+  /// @retval the number of nodes
+  int countNode(int index) const;
+  /// @}
+
+public:
+  /// @name constructor
+  /// @{
+
+  /// @brief constructor taking training file
+  ///
+  /// @param attSizes attributes sizes array ( handed to tree made )
+  /// @param nr_att the number of attributes
+  /// @param file training text file positioned at the first row
+  /// @param nr_row the number of rows in file
+  DiskID3(ATTVAL *attSizes, ATTINDEX nr_att, std::istream *file, int nr_row);
+  /// @}
+
+  /// @name destructor
+  /// @{
+
+  /// @brief default destructor
+  ~DiskID3(void);
+  /// @}
+
+  /// @name informative attributes
+  /// @{
+
+  /// @brief taking decision tree made
+  /// @details tree is built from nodes made ( and pruned ), and owns @n
+  ///          attSizes from then on; it can be taken only once
+  ///
+  /// @retval decision tree
+  DTree* takeTree(void);
+
+  /// @brief getting the number of passes over file
+  ///
+  /// @retval nr_pass
+  int getNrPass(void) const;
+
+  /// @brief getting the first malformed or out-of-range row
+  ///
+  /// @retval row number from the first row of file ( -1 if none )
+  int getBadRow(void) const;
+  /// @}
+
+  /// @name functional attributes
+  /// @{
+
+  /// @brief making decision tree level by level
+  ///
+  /// @retval true if tree is made
+  /// @retval false if a bad row is read ( see getBadRow() )
+  bool makeTree(void);
+
+  /// @brief reduced error pruning in one pass over validation rows
+  /// @details every node counts validation rows reaching it and those its @n
+  ///          majority gets right; subtrees are replaced bottom-up by @n
+  ///          their majority leaf if it makes no more errors
+  void prune(void);
+
+  /// @brief setting the maximum number of bins of continuous attr
+  ///
+  /// @param nr_bin the maximum number of bins ( 0 means default )
+  void setNrBin(int nr_bin);
+
+  /// @brief setting the maximum depth of tree
+  ///
+  /// @param maxDepth the maximum depth of tree ( 0 means no limit )
+  void setMaxDepth(int maxDepth);
+
+  /// @brief setting the minimum number of rows to split a node
+  ///
+  /// @param minRows the minimum number of rows ( 0 means no limit )
+  void setMinRows(int minRows);
+  /// @}
+};
+
+#endif /* __DISKTREE__ */
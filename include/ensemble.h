@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file ensemble.h
+/// @brief Tree Ensemble Library Header File
+/// @details Common part of ID3 tree ensembles. Member trees predict by a @n
+///          vote weighted per tree, and large input is split into row @n
+///          blocks predicted in parallel. Random forest and AdaBoost only @n
+///          differ in how they make member trees and their vote weights.
+///
+/// @section purpose_section Purpose
+/// Application trial for personal studying
+///
+
+#ifndef __TREEENSEMBLE__
+#define __TREEENSEMBLE__
+
+#include "decision.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief Tree Ensemble Class
+/// @details owns member trees, their vote weights and thread pool; @n
+///          derived classes make members
+///
+
+class Ensemble {
+protected:
+  ATTVAL    *attSizes;    ///< attribute size information array including target attr ( not owned )
+  ATTINDEX  nr_att;       ///< the number of attributes including target attribute
+  ID3       **trees;      ///< member trees ( NULL until made )
+  double    *alpha;       ///< vote weight of each member tree ( NULL means one vote each )
+  int       nr_member;    ///< the number of entries in trees
+  int       nr_thread;    ///< the number of threads of pool ( 0 means the number of cores )
+  WorkPool  *pool;        ///< thread pool shared by all trees ( NULL until first use )
+
+  /// @brief constructor taking initial values
+  ///
+  /// @param attSizes attributes sizes array
+  /// @param nr_att the number of attributes
+  Ensemble(ATTVAL *attSizes, ATTINDEX nr_att);
+
+  /// @brief getting thread pool, starting it on first use
+  ///
+  /// @retval thread pool of nr_thread threads
+  WorkPool* getPool(void);
+
+  /// @brief gathering rows of column-oriented data set into row block
+  ///
+  /// @param data data set
+  /// @param begin the first row index
+  /// @param n the number of rows
+  /// @param rows row-major block ( n rows of ( nr_att - 1 ) values )
+  void gather(const DataSet *data, int begin, int n, ATTVAL *rows) const;
+
+  /// @brief picking the value having the most votes
+  ///
+  /// @param score votes per target attribute value
+  /// @param nr_class the number of target attribute values
+  /// @retval value voted; the smallest value wins a tie ( -1 if no vote )
+  template <typename T>
+  static ATTVAL vote(const T *score, ATTVAL nr_class) {
+    ATTVAL best = -1;
+    for (ATTVAL c = 0; c < nr_class; c++)
+      if (score[c] > 0 && (best == -1 || score[c] > score[best]))
+        best = c;
+    return best;
+  }
+
+private:
+  /// @brief predicting one row block by weighted vote
+  ///
+  /// @param rows row-major instances ( n rows of ( nr_att - 1 ) values )
+  /// @param n the number of instances
+  /// @param out target attribute values predicted ( n entries )
+  void predictBlock(const ATTVAL *rows, size_t n, ATTVAL *out);
+
+  /// @brief predictBlock() task for WorkPool
+  ///
+  /// @param arg prediction task argument
+  static void predictTask(void *arg);
+
+public:
+  /// @name destructor
+  /// @{
+
+  /// @brief default destructor
+  virtual ~Ensemble(void);
+  /// @}
+
+  /// @name functional attributes
+  /// @{
+
+  /// @brief predict for new unknown instance
+  ///
+  /// @param input new unknown input
+  /// @retval target attribute value voted ( -1 if no tree can predict )
+  ATTVAL predict(ATTVAL *input);
+
+  /// @brief predict for many new unknown instances
+  /// @details large input is split into row blocks predicted by WorkPool
+  ///
+  /// @param rows row-major instances ( n rows of ( nr_att - 1 ) values )
+  /// @param n the number of instances
+  /// @param out target attribute values voted ( n entries )
+  void predictBatch(const ATTVAL *rows, size_t n, ATTVAL *out);
+
+  /// @brief setting the number of threads
+  ///
+  /// @param nr_thread the number of threads ( 0 means the number of cores )
+  void setNrThread(int nr_thread);
+  /// @}
+};
+
+#endif /* __TREEENSEMBLE__ */
@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file forest.h
+/// @brief Random Forest Library Header File
+/// @details Bagged ensemble of ID3 trees. Each tree is trained on its own @n
+///          bootstrap sample of one shared column-oriented data set, and @n
+///          takes best attr of each node among a random attr subset. @n
+///          Trees are built in parallel, and predict by majority vote @n
+///          of Ensemble. @n
+///          Rows left out of a bootstrap sample are predicted by that tree @n
+///          for out-of-bag error, so no validation set is held out.
+///
+/// @section reference_section Reference
+/// RANDOM FORESTS - LEO BREIMAN
+///
+/// @section purpose_section Purpose
+/// Application trial for personal studying
+///
+
+#ifndef __RANDOMFOREST__
+#define __RANDOMFOREST__
+
+#include "ensemble.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief Random Forest Class
+///
+
+class Forest : public Ensemble {
+private:
+  DataSet   *data;        ///< column-oriented data set shared by all trees
+  int       nr_tree;      ///< the number of trees
+  int       nr_bin;       ///< the maximum number of histogram bins ( 0 if not used )
+  bool      level;        ///< true if trees grow level by level
+  int       maxDepth;     ///< the maximum depth of trees ( 0 means no limit )
+  double    chiLevel;     ///< significance level of chi-square split test ( 0 means no test )
+  int       minRows;      ///< the minimum number of rows to split a node ( 0 means no limit )
+  unsigned  seed;         ///< random seed of forest
+  int       *votes;       ///< out-of-bag votes ( row x class ) while making forest
+  int       nr_oob;       ///< the number of rows having out-of-bag vote
+  int       nr_oob_error; ///< the number of rows whose out-of-bag vote is wrong
+
+  /// @brief building one tree and voting for its out-of-bag rows
+  ///
+  /// @param index tree index
+  /// @param seed random seed of tree
+  void makeOneTree(int index, unsigned seed);
+
+  /// @brief makeOneTree() task for WorkPool
+  ///
+  /// @param arg tree task argument
+  static void treeTask(void *arg);
+
+public:
+  /// @name constructor
+  /// @{
+
+  /// @brief constructor taking initial values
+  ///
+  /// @param attSizes attributes sizes array
+  /// @param nr_att the number of attributes
+  /// @param data training data set ( owned )
+  /// @param nr_tree the number of trees
+  Forest(ATTVAL *attSizes, ATTINDEX nr_att, DataSet *data, int nr_tree);
+  /// @}
+
+  /// @name destructor
+  /// @{
+
+  /// @brief default destructor
+  ~Forest(void);
+  /// @}
+
+  /// @name informative attributes
+  /// @{
+
+  /// @brief getting the number of trees
+  ///
+  /// @retval nr_tree
+  int getNrTree(void) const;
+
+  /// @brief getting out-of-bag error rate
+  ///
+  /// @retval wrong rows / rows having out-of-bag vote ( 0 if none )
+  double getOOBError(void) const;
+  /// @}
+
+  /// @name functional attributes
+  /// @{
+
+  /// @brief making all trees in parallel and measuring out-of-bag error
+  void makeForest(void);
+
+  /// @brief setting histogram mode of trees
+  ///
+  /// @param nr_bin the maximum number of bins per attr ( 0 turns it off )
+  void setNrBin(int nr_bin);
+
+  /// @brief setting level-wise ( breadth first ) growth of trees
+  ///
+  /// @param level true for level by level, false for depth first
+  void setLevelWise(bool level);
+
+  /// @brief setting the maximum depth of trees
+  ///
+  /// @param maxDepth the maximum depth of trees ( 0 means no limit )
+  void setMaxDepth(int maxDepth);
+
+  /// @brief setting chi-square pre-pruning of trees
+  ///
+  /// @param chiLevel significance level of split test ( 0 means no test )
+  void setSignificance(double chiLevel);
+
+  /// @brief setting the minimum number of rows to split a tree node
+  ///
+  /// @param minRows the minimum number of rows ( 0 means no limit )
+  void setMinRows(int minRows);
+  /// @}
+};
+
+#endif /* __RANDOMFOREST__ */
@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file hoeffding.h
+/// @brief Hoeffding Tree Library Header File
+/// @details VFDT for unbounded row streams. Each row is seen once: it goes @n
+///          down to a leaf and updates the ( attr x value x class ) counts @n
+///          of that leaf only. A leaf splits once the Hoeffding bound says @n
+///          its best attribute by Gain would stay best with probability @n
+///          1 - delta whatever rows come next, so work per row and memory @n
+///          per leaf are constant.
+///
+/// @section reference_section Reference
+/// MINING HIGH-SPEED DATA STREAMS - PEDRO DOMINGOS, GEOFF HULTEN
+///
+/// @section purpose_section Purpose
+/// Application trial for personal studying
+///
+
+#ifndef __HOEFFDINGTREE__
+#define __HOEFFDINGTREE__
+
+#include "decision.h"
+
+struct HoeffNode;
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief Hoeffding Tree Class
+/// @details Only nominal attributes are supported. A leaf checks its split @n
+///          every grace period rows; it splits if Gain of best attr beats @n
+///          the second best ( and not splitting ) by more than the bound, @n
+///          or the bound is so small that they are a tie.
+///
+
+class Hoeffding {
+private:
+  ATTVAL    *attSizes;    ///< attribute size information array including target attr ( not owned )
+  ATTINDEX  nr_att;       ///< the number of attributes including target attribute
+  int       *tableOffset; ///< offset of each attr in count table ( attr x value x class )
+  int       tableSize;    ///< the number of entries in count table ( class counts follow )
+  HoeffNode *node;        ///< nodes in creation order; children of a node are adjacent
+  int       nr_node;      ///< the number of nodes
+  int       max_node;     ///< capacity of node array
+  double    delta;        ///< probability that a split is not the one infinite rows make
+  int       grace;        ///< rows a leaf takes between split checks
+  int       maxDepth;     ///< the maximum depth of tree ( 0 means no limit )
+  long      nr_row;       ///< the number of rows added
+  int       nr_split;     ///< the number of leaves split
+
+  /// @name help private attributes
+  /// @{
+
+  /// @brief appending a leaf
+  ///
+  /// @param depth depth of leaf
+  /// @param val leaf value until it has rows
+  /// @param remain remaining attr flags of leaf ( owned )
+  /// @retval index of new leaf
+  int newLeaf(int depth, ATTVAL val, bool *remain);
+
+  /// @brief splitting leaf if Hoeffding bound allows
+  ///
+  /// @param index leaf index
+  void trySplit(int index);
+
+  /// @brief recursively building DTree from node array
+  ///
+  /// @param index node index
+  /// @retval decision tree node
+  DTreeNode* build(int index) const;
+  /// @}
+
+public:
+  /// @name constructor
+  /// @{
+
+  /// @brief constructor taking attribute information
+  ///
+  /// @param attSizes attributes sizes array
+  /// @param nr_att the number of attributes
+  Hoeffding(ATTVAL *attSizes, ATTINDEX nr_att);
+  /// @}
+
+  /// @name destructor
+  /// @{
+
+  /// @brief default destructor
+  ~Hoeffding(void);
+  /// @}
+
+  /// @name informative attributes
+  /// @{
+
+  /// @brief making decision tree of rows so far
+  /// @details tree has its own copy of attSizes, so rows can still be @n
+  ///          added and trees made again later
+  ///
+  /// @retval decision tree
+  DTree* makeDTree(void) const;
+
+  /// @brief getting the number of rows added
+  ///
+  /// @retval nr_row
+  long getNrRow(void) const;
+
+  /// @brief getting the number of tree nodes
+  ///
+  /// @retval nr_node
+  int getNrNode(void) const;
+
+  /// @brief getting the number of leaves split
+  ///
+  /// @retval nr_split
+  int getNrSplit(void) const;
+  /// @}
+
+  /// @name functional attributes
+  /// @{
+
+  /// @brief adding one training row
+  ///
+  /// @param row row values ( nr_att entries, target last )
+  void addRow(const ATTVAL *row);
+
+  /// @brief setting probability of a wrong split
+  ///
+  /// @param delta delta of Hoeffding bound ( 0 means default )
+  void setConfidence(double delta);
+
+  /// @brief setting rows a leaf takes between split checks
+  ///
+  /// @param grace grace period ( 0 means default )
+  void setGrace(int grace);
+
+  /// @brief setting the maximum depth of tree
+  ///
+  /// @param maxDepth the maximum depth of tree ( 0 means no limit )
+  void setMaxDepth(int maxDepth);
+  /// @}
+};
+
+#endif /* __HOEFFDINGTREE__ */
@@ -0,0 +1,226 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file incremental.h
+/// @brief Incremental Decision Tree Library Header File
+/// @details ID5R for training rows arriving over time. Every node keeps @n
+///          its ( attr x value x class ) counts, and leaves keep their @n
+///          rows. A new row only updates counts along its path; a subtree @n
+///          is restructured, pulling the new best attribute up, only when @n
+///          the test of its root stops being the best one. Restructuring @n
+///          is deferred until a tree is made ( ITI lazy restructuring ), @n
+///          so adding a row costs O( depth x attrs ).
+///
+/// @section reference_section Reference
+/// INCREMENTAL INDUCTION OF DECISION TREES - PAUL E. UTGOFF
+/// DECISION TREE INDUCTION BASED ON EFFICIENT TREE RESTRUCTURING - PAUL E.
+/// UTGOFF, NEIL C. BERKMAN, JEFFERY A. CLOUSE
+/// MACHINE LEARNING - TOM M. MITCHELL
+///
+/// @section purpose_section Purpose
+/// Application trial for personal studying
+///
+
+#ifndef __INCREMENTALTREE__
+#define __INCREMENTALTREE__
+
+#include "decision.h"
+
+struct ID5RNode;
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief ID5R Class
+/// @details Tree made is the one ID3 makes from all rows so far @n
+///          without pruning: the test of every node is its best attr by @n
+///          Gain ( the lowest index wins a tie ), and leaves are pure or @n
+///          have no attr left. Only nominal attributes are supported.
+///
+
+class ID5R {
+private:
+  ATTVAL    *attSizes;    ///< attribute size information array including target attr ( not owned )
+  ATTINDEX  nr_att;       ///< the number of attributes including target attribute
+  int       *tableOffset; ///< offset of each attr in count table ( attr x value x class )
+  int       tableSize;    ///< the number of entries in count table ( class counts follow )
+  ATTVAL    *rows;        ///< rows added so far ( row-major nr_att values )
+  int       nr_row;       ///< the number of rows added
+  int       max_row;      ///< capacity of rows
+  ID5RNode  *root;        ///< root node ( leaf until rows disagree )
+  int       nr_restruct;  ///< the number of pull-ups made
+
+  /// @name help private attributes
+  /// @{
+
+  /// @brief making empty leaf
+  ///
+  /// @retval new leaf having no row
+  ID5RNode* newLeaf(void);
+
+  /// @brief freeing node and its subtree
+  ///
+  /// @param n node to free
+  void freeNode(ID5RNode *n);
+
+  /// @brief adding a row into count table of node
+  ///
+  /// @param n node
+  /// @param row row values
+  void count(ID5RNode *n, const ATTVAL *row);
+
+  /// @brief keeping a row at leaf
+  ///
+  /// @param n leaf
+  /// @param id row id
+  void keep(ID5RNode *n, int id);
+
+  /// @brief checking if rows of node have one class at most
+  ///
+  /// @param n node
+  /// @retval true if node is pure or empty
+  bool pure(const ID5RNode *n) const;
+
+  /// @brief taking best attr by Gain of node counts
+  ///
+  /// @param n node
+  /// @param remain remaining attr flags of node
+  /// @retval best attr index ( -1 if no attr is left )
+  ATTINDEX bestAtt(const ID5RNode *n, const bool *remain) const;
+
+  /// @brief making leaf into test node on attr
+  /// @details rows of leaf move to new leaf children
+  ///
+  /// @param n leaf
+  /// @param att test attr
+  void expand(ID5RNode *n, ATTINDEX att);
+
+  /// @brief making test node into leaf keeping all rows of its subtree
+  ///
+  /// @param n test node
+  void collapse(ID5RNode *n);
+
+  /// @brief moving rows kept in subtree to leaf
+  ///
+  /// @param n subtree root
+  /// @param leaf leaf getting rows
+  void gather(ID5RNode *n, ID5RNode *leaf);
+
+  /// @brief making test node test given attr by transposition
+  /// @details every child is made to test att first, then the two top @n
+  ///          levels are swapped; grandchildren subtrees are kept as they @n
+  ///          are, and counts of new children are sums of theirs
+  ///
+  /// @param n test node not testing att
+  /// @param att attr to pull up
+  /// @param remain remaining attr flags of node
+  void pullUp(ID5RNode *n, ATTINDEX att, const bool *remain);
+
+  /// @brief making subtree the one ID3 makes from its counts
+  /// @details it goes down only where structure changes or counts @n
+  ///          changed since the last check; small subtree whose test @n
+  ///          changes is made again from its rows, which is cheaper than @n
+  ///          pull-ups there
+  ///
+  /// @param n subtree root
+  /// @param remain remaining attr flags of node
+  void ensureBest(ID5RNode *n, const bool *remain);
+
+  /// @brief recursively building DTree from nodes
+  ///
+  /// @param n node
+  /// @param empty leaf value of empty leaf
+  /// @retval decision tree node
+  DTreeNode* build(const ID5RNode *n, ATTVAL empty) const;
+
+  /// @brief the number of nodes in subtree
+  ///
+  /// @param n subtree root
+  /// @retval the number of nodes
+  int countNode(const ID5RNode *n) const;
+
+  /// @brief making empty nodes of saved tests in preorder
+  ///
+  /// @param shape test attr of each node in preorder ( -1 for leaf )
+  /// @param nr_shape the number of entries in shape
+  /// @param pos position of node in shape; it moves past the subtree
+  /// @param remain remaining attr flags of node
+  /// @retval subtree root ( NULL if shape is broken )
+  ID5RNode* shapeNode(const int *shape, int nr_shape, int &pos, bool *remain);
+  /// @}
+
+public:
+  /// @name constructor
+  /// @{
+
+  /// @brief constructor taking attribute information
+  ///
+  /// @param attSizes attributes sizes array
+  /// @param nr_att the number of attributes
+  ID5R(ATTVAL *attSizes, ATTINDEX nr_att);
+  /// @}
+
+  /// @name destructor
+  /// @{
+
+  /// @brief default destructor
+  ~ID5R(void);
+  /// @}
+
+  /// @name informative attributes
+  /// @{
+
+  /// @brief making decision tree of rows so far
+  /// @details nodes changed since the last tree are restructured first. @n
+  ///          Tree has its own copy of attSizes, so rows can still be @n
+  ///          added and trees made again later
+  ///
+  /// @retval decision tree
+  DTree* makeDTree(void);
+
+  /// @brief getting the number of rows added
+  ///
+  /// @retval nr_row
+  int getNrRow(void) const;
+
+  /// @brief getting the number of restructurings made
+  ///
+  /// @retval the number of pull-ups
+  int getNrRestruct(void) const;
+
+  /// @brief getting the number of tree nodes
+  /// @details rows added after the last tree made don't change it
+  ///
+  /// @retval the number of nodes
+  int getNrNode(void) const;
+  /// @}
+
+  /// @name functional attributes
+  /// @{
+
+  /// @brief adding one training row
+  /// @details counts on its path are updated and the row is kept at leaf
+  ///
+  /// @param row row values ( nr_att entries, target last )
+  void addRow(const ATTVAL *row);
+
+  /// @brief saving state file to add rows later
+  /// @details rows and node tests are written; counts are made again @n
+  ///          from rows when it is loaded
+  ///
+  /// @param path state file path
+  /// @retval true if saving succeeds
+  /// @retval false if file can't be written
+  bool save(const char *path) const;
+
+  /// @brief loading state file written by save()
+  /// @details every loaded node is checked again when a tree is made, @n
+  ///          so rows added after loading restructure it as usual
+  ///
+  /// @param path state file path
+  /// @param attSizes attributes sizes array read from file ( caller owns it )
+  /// @param nr_att the number of attributes read from file
+  /// @retval loaded ID5R ( NULL if file is not a valid state )
+  static ID5R* load(const char *path, ATTVAL **attSizes, ATTINDEX *nr_att);
+  /// @}
+};
+
+#endif /* __INCREMENTALTREE__ */
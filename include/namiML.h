@@ -42,6 +42,12 @@
 #include <fstream>      ///< managing console output
 #include "concept.h"
 #include "decision.h"
+#include "forest.h"
+#include "boost.h"
+#include "disk.h"
+#include "incremental.h"
+#include "hoeffding.h"
+#include "crossvalid.h"
 
 using namespace std;
 
@@ -56,6 +62,21 @@ protected:
   ios     *training;    ///< training data io stream
   ios     *answer;      ///< answer data io stream
   ostream *output;      ///< output stream
+  int     nr_thread;    ///< the number of threads ( 0 means the number of cores )
+  int     nr_bin;       ///< the maximum number of histogram bins ( 0 if not used )
+  int     nr_tree;      ///< the number of trees in ensemble
+  int     nr_depth;     ///< the maximum depth of trees ( 0 means mode default )
+  bool    level;        ///< true if trees grow level by level
+  double  significance; ///< significance level of chi-square pre-pruning ( 0 if not used )
+  int     nr_min_row;   ///< the minimum number of rows to split a tree node ( 0 if not used )
+  int     nr_max_node;  ///< node budget of best-first tree growth ( 0 if not used )
+  int     time_budget;  ///< time budget of best-first tree growth in msec ( 0 if not used )
+  int     nr_fold;      ///< the number of cross validation folds ( 0 if not used )
+  bool    bitmap;       ///< true if ID3 counts small-domain attributes by bitmap index
+  double  delta;        ///< probability of a wrong split of streaming tree ( 0 means default )
+  int     grace;        ///< rows a streaming leaf takes between split checks ( 0 means default )
+  int     nr_snapshot;  ///< rows between saving streaming model file ( 0 if not used )
+  const char *snapshot; ///< model file saved while streaming ( NULL if not used )
 public:
   /// @name constructor & destructor
   /// @{
@@ -63,11 +84,93 @@ public:
   virtual ~ML_Machine(void);
   /// @}
 
+  /// @brief setting the number of threads
+  ///
+  /// @param nr_thread the number of threads ( 0 means the number of cores )
+  void setNrThread(int nr_thread);
+
+  /// @brief setting histogram binned split for training
+  ///
+  /// @param nr_bin the maximum number of bins per attribute ( 0 if not used )
+  void setNrBin(int nr_bin);
+
+  /// @brief setting the number of trees in ensemble
+  ///
+  /// @param nr_tree the number of trees
+  void setNrTree(int nr_tree);
+
+  /// @brief setting the maximum depth of trees
+  ///
+  /// @param nr_depth the maximum depth ( 0 means mode default )
+  void setMaxDepth(int nr_depth);
+
+  /// @brief setting level-wise ( breadth first ) tree growth
+  ///
+  /// @param level true for level by level, false for depth first
+  void setLevelWise(bool level);
+
+  /// @brief setting chi-square pre-pruning of trees
+  ///
+  /// @param significance significance level of split test ( 0 if not used )
+  void setSignificance(double significance);
+
+  /// @brief setting the minimum number of rows to split a tree node
+  ///
+  /// @param nr_min_row the minimum number of rows ( 0 if not used )
+  void setMinRows(int nr_min_row);
+
+  /// @brief setting budgets of best-first tree growth
+  ///
+  /// @param nr_max_node the maximum number of tree nodes ( 0 if not used )
+  /// @param time_budget growing time budget in msec ( 0 if not used )
+  void setBudget(int nr_max_node, int time_budget);
+
+  /// @brief setting k-fold cross validation before training
+  ///
+  /// @param nr_fold the number of folds ( 0 if not used )
+  void setNrFold(int nr_fold);
+
+  /// @brief setting bitmap index counting of ID3
+  ///
+  /// @param bitmap true to count by bitmap index where it is cheaper
+  void setBitmap(bool bitmap);
+
+  /// @brief setting the probability of a wrong split of streaming tree
+  ///
+  /// @param delta probability of a wrong split ( 0 means default )
+  void setConfidence(double delta);
+
+  /// @brief setting the rows a streaming leaf takes between split checks
+  ///
+  /// @param grace the number of rows ( 0 means default )
+  void setGrace(int grace);
+
+  /// @brief setting periodic saving of streaming model file
+  ///
+  /// @param nr_snapshot rows between saving ( 0 if not used )
+  /// @param snapshot model file path
+  void setSnapshot(int nr_snapshot, const char *snapshot);
+
   /// @name functional attributes
   /// @{
   virtual bool train(void) = 0;
   virtual bool predict(void) = 0;
   virtual bool generate(void) = 0;
+
+  /// @brief learning with queries to an oracle
+  /// @details modes without query learning keep this default
+  ///
+  /// @retval false always ( not supported )
+  virtual bool query(void);
+
+  /// @brief model export & file handling
+  /// @details modes without them keep these defaults
+  ///
+  /// @param path export or model file path
+  /// @retval false always ( not supported )
+  virtual bool exportCode(const char *path);
+  virtual bool saveModel(const char *path);
+  virtual bool loadModel(const char *path);
   /// @}
 };
 
@@ -136,6 +239,14 @@ public:
   /// @retval true if generation succeeds
   /// @retval false if generation fails
   virtual bool generate(void);
+
+  /// @brief learn CE with optimal queries to an oracle
+  /// @details oracle is the answer hypothesis, and queried examples are @n
+  ///          written to training data stream
+  ///
+  /// @retval true if query learning succeeds
+  /// @retval false if query learning fails
+  virtual bool query(void);
   /// @}
 };
 
@@ -146,11 +257,45 @@ public:
 ///
 
 class ID3_Machine : public ML_Machine {
-private:
+protected:
   ATTVAL* attSizes; ///< attribute size information array including target
   ATTINDEX nr_att;    ///< the number of attr including target attr
   ID3* id3;         ///< ID3 engine
-  
+
+  /// @brief reading training data file header ( attr sizes and row count )
+  ///
+  /// @param train training data istream ( positioned at the first row after )
+  /// @param nr_row the number of rows in file
+  /// @retval true if reading succeeds
+  /// @retval false if target attribute has no value
+  bool readHeader(istream *train, int &nr_row);
+
+  /// @brief reading training data file into column-oriented data sets
+  ///
+  /// @param train_dat training data set read
+  /// @param valid_dat validation data set read ( the first quarter; NULL if @n
+  ///                  every row is for training )
+  /// @retval true if reading succeeds
+  /// @retval false if reading fails
+  bool readTrain(DataSet **train_dat, DataSet **valid_dat);
+
+  /// @brief reporting k-fold cross validation of ID3 on every training row
+  /// @details folds are index views of one data set, trained concurrently @n
+  ///          with the options of this machine ( without pruning )
+  ///
+  /// @param all data set of every training row
+  /// @retval true if validation succeeds
+  /// @retval false if there are fewer rows than folds
+  bool crossValidate(DataSet *all);
+
+  /// @brief predicting one block of parsed instances
+  ///
+  /// @param rows row-major instances ( n rows of ( nr_att - 1 ) values )
+  /// @param n the number of instances
+  /// @param out target attribute values predicted ( n entries )
+  virtual void predictBatch(const ATTVAL *rows, size_t n, ATTVAL *out);
+
+private:
   /// @brief recursively making answer tree randomly
   ///
   /// @param parent parent DTreeRoot
@@ -223,6 +368,308 @@ public:
   /// @retval true if generation succeeds
   /// @retval false if generation fails
   virtual bool generate(void);
+
+  /// @brief export trained tree as native code
+  /// @details writes C++ source; if path ends with ".so", the source is @n
+  ///          written to path.cpp and compiled to shared object at path
+  ///
+  /// @param path export file path
+  /// @retval true if export succeeds
+  /// @retval false if export fails
+  virtual bool exportCode(const char *path);
+
+  /// @brief save trained tree as binary model file
+  ///
+  /// @param path model file path
+  /// @retval true if saving succeeds
+  /// @retval false if saving fails
+  virtual bool saveModel(const char *path);
+
+  /// @brief load binary model file instead of training
+  /// @details model file is mapped read-only, and only prediction is @n
+  ///          possible with loaded model
+  ///
+  /// @param path model file path
+  /// @retval true if loading succeeds
+  /// @retval false if loading fails
+  virtual bool loadModel(const char *path);
+  /// @}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief Tree Ensemble Abstarct Machine
+/// @details ENSEMBLE_MACHINE shares data format, generation and prediction @n
+///          with ID3_MACHINE; it has many trees and no single tree to @n
+///          export, save or load
+///
+
+class Ensemble_Machine : public ID3_Machine {
+public:
+  /// @name constructor
+  /// @{
+
+  /// @brief ensemble constructor
+  ///
+  /// @param input new instance io stream
+  /// @param training training data io stream
+  /// @param answer answer data io stream
+  /// @param output output stream
+  Ensemble_Machine(ios *input, ios *training, ios *answer, ostream *output);
+  /// @}
+
+  /// @name functional attributes
+  /// @{
+
+  /// @brief export is not supported for ensemble ( ML_Machine default )
+  ///
+  /// @param path export file path
+  /// @retval false always
+  virtual bool exportCode(const char *path);
+
+  /// @brief saving is not supported for ensemble ( ML_Machine default )
+  ///
+  /// @param path model file path
+  /// @retval false always
+  virtual bool saveModel(const char *path);
+
+  /// @brief loading is not supported for ensemble ( ML_Machine default )
+  ///
+  /// @param path model file path
+  /// @retval false always
+  virtual bool loadModel(const char *path);
+  /// @}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief Random Forest Abstarct Machine
+/// @details FOREST_MACHINE shares data format, generation and prediction @n
+///          with ID3_MACHINE; every training row is used, and out-of-bag @n
+///          error replaces the validation set
+///
+
+class Forest_Machine : public Ensemble_Machine {
+private:
+  Forest* forest;   ///< random forest engine
+
+protected:
+  /// @brief predicting one block of parsed instances by majority vote
+  ///
+  /// @param rows row-major instances ( n rows of ( nr_att - 1 ) values )
+  /// @param n the number of instances
+  /// @param out target attribute values predicted ( n entries )
+  virtual void predictBatch(const ATTVAL *rows, size_t n, ATTVAL *out);
+
+public:
+  /// @name constructor & destructor
+  /// @{
+  
+  /// @brief forest constructor
+  ///
+  /// @param input new instance io stream
+  /// @param training training data io stream
+  /// @param answer answer data io stream
+  /// @param output output stream
+  Forest_Machine(ios *input, ios *training, ios *answer, ostream *output);
+
+  /// @brief forest destructor
+  virtual ~Forest_Machine(void);
+  /// @}
+  
+  /// @name functional attributes
+  /// @{
+  
+  /// @brief train forest
+  ///
+  /// @retval true if training succeeds
+  /// @retval false if training fails
+  virtual bool train(void);
+  /// @}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief AdaBoost Abstarct Machine
+/// @details BOOST_MACHINE shares data format, generation and prediction @n
+///          with ID3_MACHINE; every training row is used by each round of @n
+///          shallow trees ( stumps unless depth is given )
+///
+
+class Boost_Machine : public Ensemble_Machine {
+private:
+  Boost* boost;     ///< boosting engine
+
+protected:
+  /// @brief predicting one block of parsed instances by weighted vote
+  ///
+  /// @param rows row-major instances ( n rows of ( nr_att - 1 ) values )
+  /// @param n the number of instances
+  /// @param out target attribute values predicted ( n entries )
+  virtual void predictBatch(const ATTVAL *rows, size_t n, ATTVAL *out);
+
+public:
+  /// @name constructor & destructor
+  /// @{
+  
+  /// @brief boost constructor
+  ///
+  /// @param input new instance io stream
+  /// @param training training data io stream
+  /// @param answer answer data io stream
+  /// @param output output stream
+  Boost_Machine(ios *input, ios *training, ios *answer, ostream *output);
+
+  /// @brief boost destructor
+  virtual ~Boost_Machine(void);
+  /// @}
+  
+  /// @name functional attributes
+  /// @{
+  
+  /// @brief train boosted trees
+  ///
+  /// @retval true if training succeeds
+  /// @retval false if training fails
+  virtual bool train(void);
+  /// @}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief Out-of-core ID3 Abstarct Machine
+/// @details DISK_MACHINE shares data format, generation, prediction, export @n
+///          and model file with ID3_MACHINE; only training differs, which @n
+///          streams the training file once per tree level instead of @n
+///          loading it
+///
+
+class Disk_Machine : public ID3_Machine {
+public:
+  /// @name constructor & destructor
+  /// @{
+  
+  /// @brief out-of-core ID3 constructor
+  ///
+  /// @param input new instance io stream
+  /// @param training training data io stream
+  /// @param answer answer data io stream
+  /// @param output output stream
+  Disk_Machine(ios *input, ios *training, ios *answer, ostream *output);
+
+  /// @brief out-of-core ID3 destructor
+  virtual ~Disk_Machine(void);
+  /// @}
+  
+  /// @name functional attributes
+  /// @{
+  
+  /// @brief train decision tree level by level over training file
+  ///
+  /// @retval true if training succeeds
+  /// @retval false if training fails
+  virtual bool train(void);
+  /// @}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief Incremental ID3 Machine Class
+/// @details ID5R learner taking training rows one by one; the tree is @n
+///          restructured only where a row changes the best test. Tree @n
+///          is the unpruned ID3 tree of all rows, and predicts like it.
+///
+
+class Incremental_Machine : public ID3_Machine {
+private:
+  ID5R    *id5r;          ///< incremental tree kept for saving its state
+
+public:
+  /// @name constructor & destructor
+  /// @{
+  
+  /// @brief incremental ID3 constructor
+  ///
+  /// @param input new instance io stream
+  /// @param training training data io stream
+  /// @param answer answer data io stream
+  /// @param output output stream
+  Incremental_Machine(ios *input, ios *training, ios *answer, ostream *output);
+
+  /// @brief incremental ID3 destructor
+  virtual ~Incremental_Machine(void);
+  /// @}
+  
+  /// @name functional attributes
+  /// @{
+  
+  /// @brief train decision tree adding training rows one by one
+  /// @details rows are added to loaded state if any, so saved tree grows @n
+  ///          and is restructured instead of being trained again
+  ///
+  /// @retval true if training succeeds
+  /// @retval false if training fails
+  virtual bool train(void);
+
+  /// @brief saving incremental state ( rows and tree ) to add rows later
+  ///
+  /// @param path state file path
+  /// @retval true if saving succeeds
+  /// @retval false if saving fails
+  virtual bool saveModel(const char *path);
+
+  /// @brief loading incremental state written by saveModel()
+  /// @details tree is made for prediction unless training rows follow
+  ///
+  /// @param path state file path
+  /// @retval true if loading succeeds
+  /// @retval false if loading fails
+  virtual bool loadModel(const char *path);
+  /// @}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief Hoeffding Tree Machine Class
+/// @details VFDT learner seeing each training row once; a leaf splits @n
+///          when the Hoeffding bound says its best test is the one all @n
+///          rows of stream would pick. Training file may be a pipe, and @n
+///          0 rows in header means rows are read until end of stream.
+///
+
+class Hoeffding_Machine : public ID3_Machine {
+private:
+  /// @brief saving the tree grown so far to the model file of setSnapshot()
+  ///
+  /// @param vfdt streaming tree
+  /// @retval true if saving succeeds
+  /// @retval false if saving fails
+  bool saveSnapshot(const Hoeffding *vfdt);
+
+public:
+  /// @name constructor & destructor
+  /// @{
+  
+  /// @brief Hoeffding tree constructor
+  ///
+  /// @param input new instance io stream
+  /// @param training training data io stream
+  /// @param answer answer data io stream
+  /// @param output output stream
+  Hoeffding_Machine(ios *input, ios *training, ios *answer, ostream *output);
+
+  /// @brief Hoeffding tree destructor
+  virtual ~Hoeffding_Machine(void);
+  /// @}
+  
+  /// @name functional attributes
+  /// @{
+  
+  /// @brief train decision tree streaming training rows once
+  ///
+  /// @retval true if training succeeds
+  /// @retval false if training fails
+  virtual bool train(void);
   /// @}
 };
 
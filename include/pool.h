@@ -0,0 +1,163 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file pool.h
+/// @brief Thread Pool Library Header File
+/// @details Work-stealing task pool based on pthread. Each thread owns a @n
+///          task deque; it pushes and pops spawned tasks at the bottom @n
+///          (LIFO, cache friendly) while idle threads steal the oldest task @n
+///          at the top of other deques. Waiting thread also runs tasks @n
+///          until its group finishes, so nested waiting never blocks.
+///
+/// @section purpose_section Purpose
+/// Parallel execution of independent learning steps
+///
+
+#ifndef __WORKPOOL__
+#define __WORKPOOL__
+
+#include <pthread.h>
+
+#ifndef NULL
+#define NULL 0
+#endif
+
+typedef void (*TASKFUNC)(void *arg);  ///< task function type
+
+class WorkPool;
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief Task Group Class
+/// @details counts pending tasks spawned into this group
+///
+
+class TaskGroup {
+private:
+  volatile int nr_pending;  ///< the number of tasks not finished yet
+  friend class WorkPool;
+
+public:
+  /// @name constructor
+  /// @{
+
+  /// @brief default constructor
+  TaskGroup(void);
+  /// @}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief Work Pool Class
+/// @details Owns (nr_thread - 1) worker threads; the thread calling wait() @n
+///          from outside of the pool uses the last deque.
+///
+
+class WorkPool {
+private:
+  /// @brief one spawned task
+  struct Task {
+    TASKFUNC  func;       ///< task function
+    void      *arg;       ///< task argument
+    TaskGroup *group;     ///< group which task belongs to
+    Task      *prev;      ///< task toward top of deque
+    Task      *next;      ///< task toward bottom of deque
+  };
+
+  /// @brief task deque owned by one thread
+  struct Deque {
+    pthread_mutex_t lock; ///< deque lock
+    Task      *top;       ///< the oldest task ( stolen by others )
+    Task      *bottom;    ///< the newest task ( popped by owner )
+  };
+
+  /// @brief worker thread argument
+  struct Worker {
+    WorkPool  *pool;      ///< pool which worker belongs to
+    int       slot;       ///< deque index of worker
+  };
+
+  pthread_t       *threads;     ///< worker threads
+  Worker          *workers;     ///< worker arguments
+  Deque           *deques;      ///< one deque per thread
+  int             nr_thread;    ///< the number of threads including waiting one
+  volatile int    nr_queued;    ///< the number of tasks in all deques
+  volatile int    nr_sleeping;  ///< the number of threads sleeping on cond
+  pthread_mutex_t lock;         ///< lock for sleeping
+  pthread_cond_t  cond;         ///< signaled when task is queued or group finishes
+  volatile bool   stop;         ///< true if pool is being destroyed
+
+  /// @brief worker thread main loop
+  ///
+  /// @param arg worker argument
+  static void* workerMain(void *arg);
+
+  /// @brief deque index of current thread
+  ///
+  /// @retval own slot for worker, the last slot for outer thread
+  int mySlot(void) const;
+
+  /// @brief taking one task; own bottom first, then others' top
+  ///
+  /// @param slot deque index of current thread
+  /// @retval task taken ( NULL if all deques are empty )
+  Task* takeTask(int slot);
+
+  /// @brief running one task and finishing it
+  ///
+  /// @param task task taken from deque
+  void runTask(Task *task);
+
+  /// @brief sleeping until task is queued or condition is done
+  ///
+  /// @param group group which is waited ( NULL for worker )
+  void sleep(TaskGroup *group);
+
+public:
+  /// @name constructor
+  /// @{
+
+  /// @brief constructor taking the number of threads
+  ///
+  /// @param nr_thread the number of threads ( 0 means the number of cores )
+  WorkPool(int nr_thread);
+  /// @}
+
+  /// @name destructor
+  /// @{
+
+  /// @brief default destructor
+  ~WorkPool(void);
+  /// @}
+
+  /// @name informative attributes
+  /// @{
+
+  /// @brief getting the number of threads
+  ///
+  /// @retval the number of threads including waiting one
+  int getNrThread(void) const;
+
+  /// @brief getting the number of online cores
+  ///
+  /// @retval the number of cores ( at least 1 )
+  static int nrCore(void);
+  /// @}
+
+  /// @name functional attributes
+  /// @{
+
+  /// @brief spawning one task into deque of current thread
+  ///
+  /// @param group task group
+  /// @param func task function
+  /// @param arg task argument
+  void spawn(TaskGroup *group, TASKFUNC func, void *arg);
+
+  /// @brief waiting all tasks in group with running or stealing tasks
+  ///
+  /// @param group task group
+  void wait(TaskGroup *group);
+  /// @}
+};
+
+#endif /* __WORKPOOL__ */
@@ -0,0 +1,178 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file boost.cpp
+/// @brief AdaBoost Library Source File
+/// @details Boosted ensemble of shallow ID3 trees.
+///
+/// @section reference_section Reference
+/// MULTI-CLASS ADABOOST - JI ZHU, HUI ZOU, SAHARON ROSSET, TREVOR HASTIE
+///
+/// @section purpose_section Purpose
+/// Application trial for personal studying
+///
+
+#include "boost.h"
+#include "assertion.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Boost class implementation
+///
+
+#define BOOST_BLOCK   (1 << 10) ///< rows per training prediction block
+#define BOOST_EPSILON 1e-10     ///< error rate regarded as perfect
+
+Boost::Boost(ATTVAL *attSizes, ATTINDEX nr_att, DataSet *data, int nr_round,
+    int maxDepth) : Ensemble(attSizes, nr_att) {
+  ASSERT (data != NULL && data->getNrRow() > 0 && nr_round > 0 && maxDepth > 0,
+          (char*) "Boost condition error");
+  this->data = data;
+  this->nr_round = nr_round;
+  this->maxDepth = maxDepth;
+  nr_bin = 0;
+  level = false;
+  chiLevel = 0;
+  minRows = 0;
+  nr_error = 0;
+}
+
+Boost::~Boost() {
+  if (data)
+    delete (data);
+}
+
+int Boost::getNrRound() const {
+  return nr_member;
+}
+
+double Boost::getTrainError() const {
+  return (double) nr_error / (double) data->getNrRow();
+}
+
+void Boost::setLevelWise(bool level) {
+  this->level = level;
+}
+
+void Boost::setSignificance(double chiLevel) {
+  ASSERT (chiLevel >= 0 && chiLevel < 1, (char*) "significance level is out of range");
+  this->chiLevel = chiLevel;
+}
+
+void Boost::setMinRows(int minRows) {
+  ASSERT (minRows >= 0, (char*) "minimum rows is negative");
+  this->minRows = minRows;
+}
+
+void Boost::setNrBin(int nr_bin) {
+  ASSERT (nr_bin == 0 || nr_bin >= 2, (char*) "histogram needs two bins at least");
+  this->nr_bin = nr_bin;
+}
+
+void Boost::predictTrain(ID3 *tree, ATTVAL *out) {
+  int nr_row = data->getNrRow();
+
+  ATTVAL *rows = new ATTVAL[BOOST_BLOCK * (nr_att - 1)];
+  for (int begin = 0; begin < nr_row; begin += BOOST_BLOCK) {
+    int n = (nr_row - begin < BOOST_BLOCK) ? nr_row - begin : BOOST_BLOCK;
+    gather(data, begin, n, rows);
+    tree->predictBatch(rows, n, out + begin);
+  }
+  delete [] rows;
+}
+
+void Boost::makeBoost() {
+  int nr_row = data->getNrRow();
+  ATTVAL nr_class = attSizes[nr_att - 1];
+
+  // every row starts with the same weight
+  double *weight = new double[nr_row];
+  for (int r = 0; r < nr_row; r++)
+    weight[r] = 1.0 / nr_row;
+
+  // running weighted votes of ensemble on training rows ( row x class )
+  double *score = new double[nr_row * nr_class];
+  for (int i = 0; i < nr_row * nr_class; i++)
+    score[i] = 0;
+
+  trees = new ID3*[nr_round];
+  alpha = new double[nr_round];
+  ATTVAL *val = new ATTVAL[nr_row];
+  nr_member = 0;
+  for (int t = 0; t < nr_round; t++) {
+    ID3 *tree = new ID3(attSizes, nr_att, data, getPool());
+    tree->setWeight(weight);
+    tree->setMaxDepth(maxDepth);
+    tree->setNrBin(nr_bin);
+    tree->setLevelWise(level);
+    tree->setSignificance(chiLevel);
+    tree->setMinRows(minRows);
+    tree->makeTree();
+    tree->setWeight(NULL); // weights change for the next round
+
+    // weighted error; a row no path reaches counts as wrong
+    predictTrain(tree, val);
+    double err = 0;
+    for (int r = 0; r < nr_row; r++)
+      if (val[r] != data->getVal(r, nr_att - 1))
+        err += weight[r];
+
+    // no better than random guess; keep it only if there is nothing else
+    if (err >= 1.0 - 1.0 / nr_class) {
+      if (t > 0) {
+        delete (tree);
+        break;
+      }
+      trees[0] = tree;
+      alpha[0] = 1;
+      nr_member = 1;
+      for (int r = 0; r < nr_row; r++)
+        if (val[r] >= 0)
+          score[r * nr_class + val[r]] += 1;
+      break;
+    }
+
+    bool perfect = err < BOOST_EPSILON;
+    if (perfect)
+      err = BOOST_EPSILON;
+    trees[t] = tree;
+    alpha[t] = log((1 - err) / err) + log((double) (nr_class - 1));
+    nr_member = t + 1;
+    for (int r = 0; r < nr_row; r++)
+      if (val[r] >= 0)
+        score[r * nr_class + val[r]] += alpha[t];
+    if (perfect)
+      break; // later trees would see the same weights
+
+    // rows the tree gets wrong weigh more for the next round
+    double boost = exp(alpha[t]);
+    double sum = 0;
+    for (int r = 0; r < nr_row; r++) {
+      if (val[r] != data->getVal(r, nr_att - 1))
+        weight[r] *= boost;
+      sum += weight[r];
+    }
+    for (int r = 0; r < nr_row; r++)
+      weight[r] /= sum;
+  }
+
+  // training error of ensemble; the smallest value wins a tie
+  nr_error = 0;
+  for (int r = 0; r < nr_row; r++)
+    if (vote(score + r * nr_class, nr_class) != data->getVal(r, nr_att - 1))
+      nr_error++;
+
+  delete [] val;
+  delete [] score;
+  delete [] weight;
+
+  int nr_node = 0;
+  for (int t = 0; t < nr_member; t++)
+    nr_node += trees[t]->getNrNode();
+  cout << "///      " << nr_member << " rounds ( " << nr_node << " nodes ), "
+    << nr_error << " / " << nr_row << " training errors" << endl;
+}
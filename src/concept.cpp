@@ -54,7 +54,7 @@ Hypothesis::Hypothesis(int size, AttrVal* hypo) : size(size) {
 
 Hypothesis::~Hypothesis() {
   if(hypo)
-    delete(hypo);
+    delete [] hypo;
 }
 
 AttrVal* Hypothesis::getHypo(void) const
@@ -434,3 +434,276 @@ Result CE::predict(bool* u_input) {
 #endif
   return pred;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief version space counting helpers
+/// @details Attribute values make a small lattice per attribute; @n
+///          null < T, F < ?. Version space is the union of intervals @n
+///          [s, g] for s in S_Bound and g in G_Bound. Each interval is a @n
+///          product of per-attribute value sets, so a hypothesis is outside @n
+///          of version space iff for every interval some attribute value is @n
+///          outside of it. This is counted as a model counting problem @n
+///          ( one clause per interval, one literal per attribute ) by @n
+///          branching on attributes, never by enumerating hypotheses.
+///
+
+#define VAL_MASK(v)  (1 << (v))   ///< value bit of non-null AttrVal
+#define ALL_MASK     (VAL_MASK(vFalse) | VAL_MASK(vTrue) | VAL_MASK(vAllAccept))
+
+// check if a is more specific than or equal to b
+static inline bool isSpecificEq(AttrVal a, AttrVal b) {
+  return (a == vAllDeny || b == vAllAccept || a == b);
+}
+
+// the number of values in a value mask
+static inline int countMask(unsigned char mask) {
+  int cnt = 0;
+  for (; mask; mask >>= 1)
+    cnt += (mask & 1);
+  return cnt;
+}
+
+// mask of non-null values v outside of interval ( lo <= v <= hi )
+static inline unsigned char outMask(AttrVal lo, AttrVal hi) {
+  static const AttrVal vals[] = { vFalse, vTrue, vAllAccept };
+  unsigned char mask = 0;
+  for (int i = 0; i < 3; i++)
+    if (!isSpecificEq(lo, vals[i]) || !isSpecificEq(vals[i], hi))
+      mask |= VAL_MASK(vals[i]);
+  return mask;
+}
+
+// count hypotheses within domain masks which satisfy every active clause,
+// i.e. hypotheses which are outside of every interval.
+// out[c][i] : values of attribute i outside of interval c
+// dom[i]    : remaining possible values of attribute i
+// fixed[i]  : true if attribute i is already branched
+static double recursive_count_out(unsigned char **out, int *active, int nr_active,
+    unsigned char *dom, bool *fixed, int size) {
+  // step 1. drop satisfied clauses, find dead clauses and unit clauses
+  int *next = new int[nr_active + 1];
+  int nr_next = 0;
+  int unit_att = -1;
+  int unit_cl = -1;
+  for (int c = 0; c < nr_active; c++) {
+    unsigned char *cl = out[active[c]];
+    bool sat = false;
+    int nr_lit = 0;
+    int last = -1;
+    for (int i = 0; i < size && !sat; i++) {
+      if (!(cl[i] & dom[i]))
+        continue;
+      if (fixed[i])
+        sat = true;
+      else {
+        nr_lit++;
+        last = i;
+      }
+    }
+    if (sat)
+      continue;
+    if (nr_lit == 0) { // no way to get out of this interval
+      delete [] next;
+      return 0;
+    }
+    if (nr_lit == 1 && unit_att == -1) {
+      unit_att = last;
+      unit_cl = active[c];
+    }
+    next[nr_next++] = active[c];
+  }
+
+  // step 2. no clause remains; all remaining combinations are counted
+  if (nr_next == 0) {
+    double ret = 1;
+    for (int i = 0; i < size; i++)
+      if (!fixed[i])
+        ret *= countMask(dom[i]);
+    delete [] next;
+    return ret;
+  }
+
+  // step 3. branch on unit clause attribute or the most frequent attribute
+  int att = unit_att;
+  if (att == -1) {
+    int best = 0;
+    for (int i = 0; i < size; i++) {
+      if (fixed[i])
+        continue;
+      int freq = 0;
+      for (int c = 0; c < nr_next; c++)
+        if (out[next[c]][i] & dom[i])
+          freq++;
+      if (freq > best) {
+        best = freq;
+        att = i;
+      }
+    }
+  }
+
+  double ret = 0;
+  unsigned char saved = dom[att];
+  // other values would make the unit clause fail
+  unsigned char branch = (att == unit_att) ? (saved & out[unit_cl][att]) : saved;
+  fixed[att] = true;
+  for (int v = 0; v < 3; v++) {
+    if (!(branch & VAL_MASK(v)))
+      continue;
+    dom[att] = VAL_MASK(v);
+    ret += recursive_count_out(out, next, nr_next, dom, fixed, size);
+  }
+  dom[att] = saved;
+  fixed[att] = false;
+
+  delete [] next;
+  return ret;
+}
+
+void CE::countVS(bool* u_input, double &all, double &pos) {
+  all = 0;
+  pos = 0;
+
+  List <Hypothesis*> *sb = s_bound->sb_Array;
+  List <Hypothesis*> *gb = g_bound->gb_Array;
+
+  // every (s, g) pair with s <= g is an interval of version space
+  int nr_pair = 0;
+  bool empty = false; // true if the empty hypothesis is in version space
+  unsigned char **out = new unsigned char*[sb->getSize() * gb->getSize() + 1];
+  for (unsigned int i = 0; i < sb->getSize(); i++) {
+    AttrVal *lo = sb->getContent(i)->getHypo();
+    for (unsigned int j = 0; j < gb->getSize(); j++) {
+      if (!gb->getContent(j)->isMoreGeneralThanEqualTo(sb->getContent(i)))
+        continue;
+      AttrVal *hi = gb->getContent(j)->getHypo();
+      out[nr_pair] = new unsigned char[size];
+      for (int k = 0; k < size; k++) {
+        out[nr_pair][k] = outMask(lo[k], hi[k]);
+        if (lo[k] == vAllDeny)
+          empty = true;
+      }
+      nr_pair++;
+    }
+  }
+
+  // an interval included in another one changes nothing in the union
+  int *active = new int[nr_pair + 1];
+  int nr_active = 0;
+  for (int c = 0; c < nr_pair; c++) {
+    bool redundant = false;
+    for (int d = 0; d < nr_pair && !redundant; d++) {
+      if (d == c)
+        continue;
+      bool included = true; // interval c is included in interval d
+      bool same = true;
+      for (int k = 0; k < size && included; k++) {
+        if ((out[d][k] & ~out[c][k]) != 0)
+          included = false;
+        if (out[d][k] != out[c][k])
+          same = false;
+      }
+      // keep the first one of the same intervals
+      redundant = included && (!same || d < c);
+    }
+    if (!redundant)
+      active[nr_active++] = c;
+  }
+  unsigned char *dom = new unsigned char[size];
+  bool *fixed = new bool[size];
+
+  if (nr_pair > 0) {
+    // all non-null hypotheses minus hypotheses out of version space
+    double total = 1;
+    for (int i = 0; i < size; i++) {
+      dom[i] = ALL_MASK;
+      fixed[i] = false;
+      total *= 3;
+    }
+    all = total - recursive_count_out(out, active, nr_active, dom, fixed, size);
+    if (empty)
+      all += 1; // empty hypothesis never covers any instance
+
+    // the same with hypotheses covering u_input only
+    if (u_input) {
+      total = 1;
+      for (int i = 0; i < size; i++) {
+        dom[i] = VAL_MASK(vAllAccept) | VAL_MASK(u_input[i] ? vTrue : vFalse);
+        total *= 2;
+      }
+      pos = total - recursive_count_out(out, active, nr_active, dom, fixed, size);
+    }
+  }
+
+  for (int c = 0; c < nr_pair; c++)
+    delete [] out[c];
+  delete [] out;
+  delete [] active;
+  delete [] dom;
+  delete [] fixed;
+}
+
+double CE::vote(bool* u_input) {
+  double all, pos;
+  countVS(u_input, all, pos);
+
+  if (all <= 0)
+    return -1; // empty version space
+
+  return pos / all;
+}
+
+double CE::sizeVS(void) {
+  double all, pos;
+  countVS(NULL, all, pos);
+  return all;
+}
+
+double CE::query(bool* query) {
+  // step 1. start from an instance covered by the first consistent bound
+  Hypothesis *start = NULL;
+  for (unsigned int i = 0; i < s_bound->sb_Array->getSize() && !start; i++) {
+    Hypothesis *s = s_bound->sb_Array->getContent(i);
+    bool empty = false;
+    for (int j = 0; j < size; j++)
+      if (s->getHypo()[j] == vAllDeny)
+        empty = true;
+    if (!empty)
+      start = s;
+  }
+  // no positive example yet; S is empty hypothesis, so take G
+  for (unsigned int i = 0; i < g_bound->gb_Array->getSize() && !start; i++)
+    start = g_bound->gb_Array->getContent(i);
+  if (!start)
+    return -1;
+
+  for (int i = 0; i < size; i++)
+    query[i] = (start->getHypo()[i] != vFalse);
+
+  double frac = vote(query);
+  if (frac < 0)
+    return -1;
+
+  // step 2. greedy flips toward half of version space
+  while (true) {
+    int best = -1;
+    double best_frac = frac;
+    for (int i = 0; i < size; i++) {
+      query[i] = !query[i];
+      double cur = vote(query);
+      query[i] = !query[i];
+      double cur_dist = (cur > 0.5) ? cur - 0.5 : 0.5 - cur;
+      double best_dist = (best_frac > 0.5) ? best_frac - 0.5 : 0.5 - best_frac;
+      if (cur_dist < best_dist) {
+        best = i;
+        best_frac = cur;
+      }
+    }
+    if (best == -1)
+      break;
+    query[best] = !query[best];
+    frac = best_frac;
+  }
+
+  return frac;
+}
@@ -0,0 +1,261 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file crossvalid.cpp
+/// @brief Cross Validation Library Source File
+/// @details k-fold cross validation of ID3 on row index views.
+///
+/// @section reference_section Reference
+/// A STUDY OF CROSS-VALIDATION AND BOOTSTRAP FOR ACCURACY ESTIMATION AND
+/// MODEL SELECTION - RON KOHAVI
+///
+/// @section purpose_section Purpose
+/// Application trial for personal studying
+///
+
+#include "crossvalid.h"
+#include "assertion.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <sys/time.h>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// CrossValid class implementation
+///
+
+#define CV_SEED       12345     ///< random seed of fold assignment
+#define CV_BLOCK      (1 << 10) ///< rows predicted at once
+
+/// @brief wall clock in msec
+static double nowMsec(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+CrossValid::CrossValid(ATTVAL *attSizes, ATTINDEX nr_att, DataSet *data,
+    int nr_fold) {
+  ASSERT (attSizes != NULL && nr_att > 1 && data != NULL && nr_fold >= 2 &&
+          nr_fold <= data->getNrRow(), (char*) "CrossValid condition error");
+  this->attSizes = attSizes;
+  this->nr_att = nr_att;
+  this->data = data;
+  this->nr_fold = nr_fold;
+  foldOf = NULL;
+  accuracy = new double[nr_fold];
+  msec = new double[nr_fold];
+  nr_node = new int[nr_fold];
+  for (int f = 0; f < nr_fold; f++) {
+    accuracy[f] = 0;
+    msec[f] = 0;
+    nr_node[f] = 0;
+  }
+  nr_bin = 0;
+  level = false;
+  maxDepth = 0;
+  chiLevel = 0;
+  minRows = 0;
+  maxNodes = 0;
+  timeBudget = 0;
+  bitmap = false;
+  seed = CV_SEED;
+  nr_thread = 0;
+  pool = NULL;
+}
+
+CrossValid::~CrossValid() {
+  if (foldOf)
+    delete [] foldOf;
+  delete [] accuracy;
+  delete [] msec;
+  delete [] nr_node;
+
+  if (pool)
+    delete (pool);
+}
+
+double CrossValid::getMean() const {
+  double sum = 0;
+  for (int f = 0; f < nr_fold; f++)
+    sum += accuracy[f];
+  return sum / nr_fold;
+}
+
+double CrossValid::getStdDev() const {
+  double mean = getMean();
+  double sum = 0;
+  for (int f = 0; f < nr_fold; f++)
+    sum += (accuracy[f] - mean) * (accuracy[f] - mean);
+  return sqrt(sum / (nr_fold - 1));
+}
+
+double CrossValid::getAccuracy(int fold) const {
+  ASSERT (fold >= 0 && fold < nr_fold, (char*) "fold is out of range");
+  return accuracy[fold];
+}
+
+double CrossValid::getMsec(int fold) const {
+  ASSERT (fold >= 0 && fold < nr_fold, (char*) "fold is out of range");
+  return msec[fold];
+}
+
+int CrossValid::getNrNode(int fold) const {
+  ASSERT (fold >= 0 && fold < nr_fold, (char*) "fold is out of range");
+  return nr_node[fold];
+}
+
+void CrossValid::setNrThread(int nr_thread) {
+  this->nr_thread = nr_thread;
+  if (pool) { // started again with the new count on next use
+    delete (pool);
+    pool = NULL;
+  }
+}
+
+WorkPool* CrossValid::getPool() {
+  // threads start on first parallel use, so setNrThread() never wastes them
+  if (!pool)
+    pool = new WorkPool(nr_thread);
+  return pool;
+}
+
+void CrossValid::setNrBin(int nr_bin) {
+  ASSERT (nr_bin == 0 || nr_bin >= 2, (char*) "histogram needs two bins at least");
+  this->nr_bin = nr_bin;
+}
+
+void CrossValid::setLevelWise(bool level) {
+  this->level = level;
+}
+
+void CrossValid::setMaxDepth(int maxDepth) {
+  ASSERT (maxDepth >= 0, (char*) "max depth is negative");
+  this->maxDepth = maxDepth;
+}
+
+void CrossValid::setSignificance(double chiLevel) {
+  ASSERT (chiLevel >= 0 && chiLevel < 1, (char*) "significance level is out of range");
+  this->chiLevel = chiLevel;
+}
+
+void CrossValid::setMinRows(int minRows) {
+  ASSERT (minRows >= 0, (char*) "minimum rows is negative");
+  this->minRows = minRows;
+}
+
+void CrossValid::setBudget(int maxNodes, int timeBudget) {
+  ASSERT (maxNodes >= 0 && timeBudget >= 0, (char*) "budget is negative");
+  this->maxNodes = maxNodes;
+  this->timeBudget = timeBudget;
+}
+
+void CrossValid::setBitmap(bool bitmap) {
+  this->bitmap = bitmap;
+}
+
+/// @brief argument of one fold task; trains and tests one fold
+struct FoldArg {
+  CrossValid  *cv;        ///< cross validation which fold belongs to
+  int         fold;       ///< fold index
+};
+
+void CrossValid::foldTask(void *arg) {
+  FoldArg *t = (FoldArg*) arg;
+  t->cv->runFold(t->fold);
+}
+
+void CrossValid::runFold(int fold) {
+  int nr_row = data->getNrRow();
+  int stride = nr_att - 1;
+
+  // index views in row order, so columns are read forward
+  int nr_test = 0;
+  for (int r = 0; r < nr_row; r++)
+    if (foldOf[r] == fold)
+      nr_test++;
+  int *sample = new int[nr_row - nr_test];
+  int *test = new int[nr_test];
+  int nr_sample = 0;
+  nr_test = 0;
+  for (int r = 0; r < nr_row; r++) {
+    if (foldOf[r] == fold)
+      test[nr_test++] = r;
+    else
+      sample[nr_sample++] = r;
+  }
+
+  double start = nowMsec();
+  ID3 *tree = new ID3(attSizes, nr_att, data, getPool());
+  tree->setSample(sample, nr_sample);
+  tree->setNrBin(nr_bin);
+  tree->setLevelWise(level);
+  tree->setMaxDepth(maxDepth);
+  tree->setSignificance(chiLevel);
+  tree->setMinRows(minRows);
+  tree->setBudget(maxNodes, timeBudget);
+  tree->setBitmap(bitmap);
+  tree->makeTree();
+  msec[fold] = nowMsec() - start;
+  nr_node[fold] = tree->getNrNode();
+
+  // held-out rows are gathered from columns one block at a time
+  ATTVAL *rows = new ATTVAL[CV_BLOCK * stride];
+  ATTVAL *out = new ATTVAL[CV_BLOCK];
+  int nr_right = 0;
+  for (int begin = 0; begin < nr_test; begin += CV_BLOCK) {
+    int n = (nr_test - begin < CV_BLOCK) ? nr_test - begin : CV_BLOCK;
+    for (ATTINDEX a = 0; a < stride; a++)
+      for (int i = 0; i < n; i++)
+        rows[i * stride + a] = data->getVal(test[begin + i], a);
+    tree->predictBatch(rows, n, out);
+    for (int i = 0; i < n; i++)
+      if (out[i] == data->getVal(test[begin + i], nr_att - 1))
+        nr_right++;
+  }
+  accuracy[fold] = (double) nr_right / (double) nr_test;
+
+  delete [] out;
+  delete [] rows;
+  delete (tree);
+  delete [] test;
+  delete [] sample;
+}
+
+void CrossValid::validate() {
+  int nr_row = data->getNrRow();
+
+  // shuffled rows are dealt to folds in turn, so fold sizes differ by one
+  // at most and every fold sees classes in proportion on average
+  int *order = new int[nr_row];
+  for (int r = 0; r < nr_row; r++)
+    order[r] = r;
+  unsigned state = seed;
+  for (int r = nr_row - 1; r > 0; r--) {
+    int j = rand_r(&state) % (r + 1);
+    int tmp = order[r];
+    order[r] = order[j];
+    order[j] = tmp;
+  }
+  if (!foldOf)
+    foldOf = new int[nr_row];
+  for (int i = 0; i < nr_row; i++)
+    foldOf[order[i]] = i % nr_fold;
+  delete [] order;
+
+  // one bitmap index serves every fold tree
+  if (bitmap && ID3::bitmapSupported())
+    data->makeBitmap(attSizes);
+
+  FoldArg *args = new FoldArg[nr_fold];
+  TaskGroup group;
+  for (int f = 0; f < nr_fold; f++) {
+    args[f].cv = this;
+    args[f].fold = f;
+    getPool()->spawn(&group, foldTask, &args[f]);
+  }
+  getPool()->wait(&group);
+  delete [] args;
+}
@@ -18,28 +18,23 @@
 ///
 
 #include "decision.h"
+#include "assertion.h"
 #include <iostream>
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <sys/stat.h>
 
 #define DEBUG_MODE  1
 
 using namespace std;
 
-////////////////////////////////////////////////////////////////////////////////
-///
-/// self-implemented assert function
-///
-
-static inline void ASSERT(bool exp, char* message = NULL) {
-  if (!exp) {
-    cout << "ASSERT" << endl;
-    if (message)
-      cout << "ERROR: " << message << endl;
-    exit(-1);
-  }
-}
-
 ////////////////////////////////////////////////////////////////////////////////
 ///
 /// DTreeNode class implementation
@@ -75,6 +70,11 @@ DTreeRoot::DTreeRoot() {
   attIndex = -1; // no index
   child = NULL;
   nr_child = 0; // no child
+  major = -1; // no value
+  numeric = false;
+  threshold = 0;
+  group = NULL;
+  nr_group = 0;
 }
 
 DTreeRoot::DTreeRoot(ATTINDEX attIndex, DTreeNode **child, ATTVAL nr_child) {
@@ -82,14 +82,21 @@ DTreeRoot::DTreeRoot(ATTINDEX attIndex, DTreeNode **child, ATTVAL nr_child) {
   this->attIndex = attIndex;
   this->child = child;
   this->nr_child = nr_child;
+  major = -1; // no value
+  numeric = false;
+  threshold = 0;
+  group = NULL;
+  nr_group = 0;
 }
 
 DTreeRoot::~DTreeRoot() {
   if (child && nr_child != 0) {
     for (int i = 0; i < nr_child; i++)
       delete (child[i]);
-    delete (child);
+    delete [] child;
   }
+  if (group)
+    delete [] group;
 }
 
 ATTINDEX DTreeRoot::getAttIndex() const {
@@ -109,6 +116,26 @@ ATTVAL DTreeRoot::getNrChild() const {
   return nr_child;
 }
 
+ATTVAL DTreeRoot::getMajor() const {
+  return major;
+}
+
+bool DTreeRoot::isNumeric() const {
+  return numeric;
+}
+
+ATTVAL DTreeRoot::getThreshold() const {
+  return threshold;
+}
+
+const ATTVAL* DTreeRoot::getGroup() const {
+  return group;
+}
+
+ATTVAL DTreeRoot::getNrGroup() const {
+  return nr_group;
+}
+
 void DTreeRoot::setAttIndex(ATTINDEX attIndex) {
   ASSERT (attIndex >= 0);
   this->attIndex = attIndex;
@@ -129,6 +156,26 @@ void DTreeRoot::setNrChild(ATTVAL nr_child) {
   this->nr_child = nr_child;
 }
 
+void DTreeRoot::setMajor(ATTVAL major) {
+  ASSERT (major >= 0);
+  this->major = major;
+}
+
+void DTreeRoot::setThreshold(ATTVAL threshold) {
+  ASSERT (nr_child == 2, (char*) "threshold test needs two children");
+  numeric = true;
+  this->threshold = threshold;
+}
+
+void DTreeRoot::setGroup(ATTVAL *group, ATTVAL nr_group) {
+  ASSERT (nr_child == 2, (char*) "grouping test needs two children");
+  ASSERT (group != NULL && nr_group > 0, (char*) "group is not valid");
+  if (this->group)
+    delete [] this->group;
+  this->group = group;
+  this->nr_group = nr_group;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 /// DTreeLeaf class implementation
@@ -177,7 +224,7 @@ DTree::~DTree() {
   if (root)
     delete (root);
   if (att_size_array)
-    delete (att_size_array);
+    delete [] att_size_array;
 }
 
 DTreeNode* DTree::getRoot() const {
@@ -208,12 +255,12 @@ DTreeLeaf* DTree::getLeaf(ATTVAL* attArray) const {
     ASSERT (link->getChildArray() != NULL, (char*) "child array doesn't exist");
     ASSERT (link->getAttIndex() >= 0 && link->getAttIndex() < nr_att,
       (char*) "attIndex is not valid");
-    ASSERT (attArray[link->getAttIndex()] >= 0 &&
-      attArray[link->getAttIndex()] < link->getNrChild(),
+    ATTVAL branch = link->getBranch(attArray[link->getAttIndex()]);
+    ASSERT (branch >= 0 && branch < link->getNrChild(),
       (char*) "attArray value is not valid");
-    ASSERT (link->getOneChild(attArray[link->getAttIndex()]) != NULL,
+    ASSERT (link->getOneChild(branch) != NULL,
       (char*) "child doesn't exist");
-    cur = link->getOneChild(attArray[link->getAttIndex()]);
+    cur = link->getOneChild(branch);
   }
 }
 
@@ -231,14 +278,701 @@ void DTree::setNrAtt(ATTINDEX nr_att) {
   this->nr_att = nr_att;
 }
 
+static void export_code_indent(ostream *out, int depth) {
+  for (int i = 0; i < depth; i++)
+    (*out) << "  ";
+}
+
+/// @brief writing value-to-child bit set of each grouping test ( preorder )
+static void recursive_export_group(DTreeNode *cur, ostream *out, int &nr_group) {
+  DTreeRoot *link = dynamic_cast <DTreeRoot*> (cur);
+  if (!link)
+    return;
+
+  if (link->getGroup()) {
+    int nr_word = (link->getNrGroup() + 31) / 32;
+    (*out) << "static const unsigned group" << nr_group++ << "[" << nr_word << "] = {";
+    for (int w = 0; w < nr_word; w++) {
+      unsigned bits = 0;
+      for (int k = 0; k < 32 && w * 32 + k < link->getNrGroup(); k++)
+        if (link->getGroup()[w * 32 + k])
+          bits |= 1u << k;
+      (*out) << ((w % 8 == 0) ? "\n  " : " ") << "0x" << hex << bits << dec << "u,";
+    }
+    (*out) << '\n' << "};" << '\n';
+  }
+  for (int i = 0; i < link->getNrChild(); i++)
+    recursive_export_group(link->getOneChild(i), out, nr_group);
+}
+
+static void recursive_export_code(DTreeNode *cur, ostream *out, int depth,
+    int &nr_group) {
+  if (DTreeLeaf *leaf = dynamic_cast <DTreeLeaf*> (cur)) {
+    export_code_indent(out, depth);
+    (*out) << "return " << leaf->getVal() << ";" << '\n';
+    return;
+  }
+
+  DTreeRoot *link = dynamic_cast <DTreeRoot*> (cur);
+  ASSERT (link != NULL, (char*) "link is not valid");
+  if (link->isNumeric() || link->getGroup()) {
+    export_code_indent(out, depth);
+    if (link->isNumeric()) {
+      (*out) << "if (att[" << link->getAttIndex() << "] <= " << link->getThreshold()
+        << ") {" << '\n';
+    } else { // grouping test; set bit means second child
+      int index = nr_group++;
+      (*out) << "if ((unsigned) att[" << link->getAttIndex() << "] >= "
+        << link->getNrGroup() << "u) return -1;" << '\n';
+      export_code_indent(out, depth);
+      (*out) << "if (!((group" << index << "[att[" << link->getAttIndex()
+        << "] >> 5] >> (att[" << link->getAttIndex() << "] & 31)) & 1)) {" << '\n';
+    }
+    recursive_export_code(link->getOneChild(0), out, depth + 1, nr_group);
+    export_code_indent(out, depth);
+    (*out) << "} else {" << '\n';
+    recursive_export_code(link->getOneChild(1), out, depth + 1, nr_group);
+    export_code_indent(out, depth);
+    (*out) << "}" << '\n';
+    return;
+  }
+
+  export_code_indent(out, depth);
+  (*out) << "switch (att[" << link->getAttIndex() << "]) {" << '\n';
+  for (int i = 0; i < link->getNrChild(); i++) {
+    export_code_indent(out, depth);
+    (*out) << "case " << i << ":" << '\n';
+    recursive_export_code(link->getOneChild(i), out, depth + 1, nr_group);
+  }
+  export_code_indent(out, depth);
+  (*out) << "default:" << '\n';
+  export_code_indent(out, depth + 1);
+  (*out) << "return -1;" << '\n';
+  export_code_indent(out, depth);
+  (*out) << "}" << '\n';
+}
+
+void DTree::exportCode(ostream *out) const {
+  ASSERT (out != NULL && root != NULL, (char*) "exportCode condition error");
+
+  (*out) << "////////////////////////////////////////////////////////////////////////////////" << '\n'
+         << "///" << '\n'
+         << "/// decision tree compiled by namiML" << '\n'
+         << "///   build : c++ -O2 -shared -fPIC -o tree.so tree.cpp" << '\n'
+         << "///   call  : int predict(const int *att); att has nr_input() values," << '\n'
+         << "///           and -1 is returned if att has invalid value on the path" << '\n'
+         << "///" << '\n' << '\n'
+         << "extern \"C\" int nr_input(void) {" << '\n'
+         << "  return " << nr_att - 1 << ";" << '\n'
+         << "}" << '\n' << '\n';
+
+  // grouping tests are numbered in the same preorder by both passes
+  int nr_group = 0;
+  recursive_export_group(root, out, nr_group);
+  if (nr_group > 0)
+    (*out) << '\n';
+  nr_group = 0;
+  (*out) << "extern \"C\" int predict(const int *att) {" << '\n';
+  recursive_export_code(root, out, 1, nr_group);
+  (*out) << "  return -1;" << '\n'
+         << "}" << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// FlatTree class implementation
+///
+
+static int count_node(DTreeNode *cur) {
+  DTreeRoot *link = dynamic_cast <DTreeRoot*> (cur);
+  if (!link)
+    return 1;
+
+  int count = 1;
+  for (int i = 0; i < link->getNrChild(); i++)
+    count += count_node(link->getOneChild(i));
+  return count;
+}
+
+FlatTree::FlatTree() {
+  node16 = NULL;
+  node32 = NULL;
+  thres = NULL;
+  groups = NULL;
+  nr_groups = 0;
+  nr_node = 0;
+  attSizes = NULL;
+  nr_att = 0;
+  map = NULL;
+  map_size = 0;
+}
+
+FlatTree::FlatTree(DTree *tree) {
+  ASSERT (tree != NULL && tree->getRoot() != NULL, (char*) "tree has no root");
+  attSizes = tree->getAttSizeArray();
+  nr_att = tree->getNrAtt();
+  map = NULL;
+  map_size = 0;
+  nr_node = count_node(tree->getRoot());
+
+  // breadth first layout; children of a node are pushed adjacently
+  DTreeNode **queue = new DTreeNode*[nr_node];
+  int *att = new int[nr_node];
+  int *link = new int[nr_node];
+  int tail = 0;
+  int widest = nr_node;
+  thres = NULL;
+  groups = NULL;
+  nr_groups = 0;
+  queue[tail++] = tree->getRoot();
+  for (int head = 0; head < nr_node; head++) {
+    if (DTreeLeaf *leaf = dynamic_cast <DTreeLeaf*> (queue[head])) {
+      att[head] = -1;
+      link[head] = leaf->getVal();
+    } else {
+      DTreeRoot *root = dynamic_cast <DTreeRoot*> (queue[head]);
+      ASSERT (root != NULL, (char*) "node is not valid");
+      att[head] = root->getAttIndex();
+      link[head] = tail;
+      for (int i = 0; i < root->getNrChild(); i++)
+        queue[tail++] = root->getOneChild(i);
+      if (root->isNumeric() || root->getGroup()) {
+        if (!thres) {
+          thres = new int[nr_node];
+          for (int i = 0; i < nr_node; i++)
+            thres[i] = 0;
+        }
+      }
+      if (root->isNumeric()) {
+        att[head] = -2 - att[head];
+        thres[head] = root->getThreshold();
+      } else if (root->getGroup()) {
+        att[head] = -2 - nr_att - att[head];
+        thres[head] = nr_groups; // offset of its map in groups
+        nr_groups += root->getNrGroup();
+      }
+    }
+    if (-att[head] > widest)
+      widest = -att[head];
+    if (att[head] > widest)
+      widest = att[head];
+    if (link[head] > widest)
+      widest = link[head];
+  }
+
+  // second pass for group maps, now that the total size is known
+  if (nr_groups > 0) {
+    groups = new int[nr_groups];
+    for (int i = 0; i < nr_node; i++) {
+      DTreeRoot *root = dynamic_cast <DTreeRoot*> (queue[i]);
+      if (!root || !root->getGroup())
+        continue;
+      for (ATTVAL v = 0; v < root->getNrGroup(); v++)
+        groups[thres[i] + v] = root->getGroup()[v];
+    }
+  }
+
+  node16 = NULL;
+  node32 = NULL;
+  if (widest <= 32767) {
+    node16 = new short[2 * nr_node];
+    for (int i = 0; i < nr_node; i++) {
+      node16[2 * i] = (short) att[i];
+      node16[2 * i + 1] = (short) link[i];
+    }
+  } else {
+    node32 = new int[2 * nr_node];
+    for (int i = 0; i < nr_node; i++) {
+      node32[2 * i] = att[i];
+      node32[2 * i + 1] = link[i];
+    }
+  }
+
+  delete [] queue;
+  delete [] att;
+  delete [] link;
+}
+
+FlatTree::~FlatTree() {
+  if (map) { // nodes live in mapped file
+    munmap(map, map_size);
+    return;
+  }
+  if (node16)
+    delete [] node16;
+  if (node32)
+    delete [] node32;
+  if (thres)
+    delete [] thres;
+  if (groups)
+    delete [] groups;
+}
+
+int FlatTree::getNrNode() const {
+  return nr_node;
+}
+
+int FlatTree::getNrByte() const {
+  return 2 * nr_node * (node16 ? sizeof(short) : sizeof(int));
+}
+
+ATTINDEX FlatTree::getNrAtt() const {
+  return nr_att;
+}
+
+const ATTVAL* FlatTree::getAttSizeArray() const {
+  return attSizes;
+}
+
+#define MODEL_MAGIC   "namiDT\n"  ///< model file magic ( 8 bytes with NUL )
+#define MODEL_VERSION 3           ///< model file format version
+
+/// @brief binary model file header
+struct ModelHeader {
+  char  magic[8];     ///< MODEL_MAGIC
+  int   version;      ///< MODEL_VERSION
+  int   nr_att;       ///< the number of attributes including target attr
+  int   nr_node;      ///< the number of nodes
+  int   width;        ///< bytes of one node field ( 2 or 4 )
+  int   numeric;      ///< 1 if side array ( threshold, group offset ) follows node array
+  int   nr_groups;    ///< the number of entries in group array
+};
+
+bool FlatTree::save(const char *path) const {
+  ASSERT (path != NULL, (char*) "model path is NULL");
+
+  ofstream file(path, ios::out | ios::binary | ios::trunc);
+  if (!file.is_open())
+    return false;
+
+  ModelHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MODEL_MAGIC, sizeof(header.magic));
+  header.version = MODEL_VERSION;
+  header.nr_att = nr_att;
+  header.nr_node = nr_node;
+  header.width = (node16) ? sizeof(short) : sizeof(int);
+  header.numeric = (thres) ? 1 : 0;
+  header.nr_groups = nr_groups;
+
+  file.write((const char*) &header, sizeof(header));
+  file.write((const char*) attSizes, nr_att * sizeof(ATTVAL));
+  if (node16)
+    file.write((const char*) node16, 2 * nr_node * sizeof(short));
+  else
+    file.write((const char*) node32, 2 * nr_node * sizeof(int));
+  if (thres)
+    file.write((const char*) thres, nr_node * sizeof(int));
+  if (groups)
+    file.write((const char*) groups, nr_groups * sizeof(int));
+  file.close();
+
+  return !file.fail();
+}
+
+/// @brief checking loaded node array; links only go forward ( breadth
+///        first ) and stay in array, so any walk terminates in bounds
+template <typename NODE>
+static bool flat_check(const NODE *node, const int *thres, const int *groups,
+    int nr_groups, int nr_node, const ATTVAL *attSizes, ATTINDEX nr_att) {
+  for (int i = 0; i < nr_node; i++) {
+    int att = node[2 * i];
+    int link = node[2 * i + 1];
+    if (att == -1) {
+      if (link < 0 || link >= attSizes[nr_att - 1])
+        return false;
+    } else if (att < -1 && -2 - att < nr_att) { // threshold test on continuous attr
+      if (!thres || -2 - att >= nr_att - 1 || attSizes[-2 - att] != 0 ||
+          link <= i || link > nr_node - 2)
+        return false;
+    } else if (att < -1) { // grouping test on nominal attr
+      int a = -2 - nr_att - att;
+      if (!thres || a >= nr_att - 1 || attSizes[a] == 0 || link <= i ||
+          link > nr_node - 2 || thres[i] < 0 || thres[i] > nr_groups - attSizes[a])
+        return false;
+      for (ATTVAL v = 0; v < attSizes[a]; v++)
+        if (groups[thres[i] + v] != 0 && groups[thres[i] + v] != 1)
+          return false;
+    } else if (att >= nr_att - 1 || attSizes[att] == 0 || link <= i ||
+        link > nr_node - attSizes[att]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+FlatTree* FlatTree::load(const char *path) {
+  ASSERT (path != NULL, (char*) "model path is NULL");
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(ModelHeader)) {
+    close(fd);
+    return NULL;
+  }
+  void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // mapping stays valid
+  if (map == MAP_FAILED)
+    return NULL;
+
+  // header check; size must match exactly
+  const ModelHeader *header = (const ModelHeader*) map;
+  bool good = memcmp(header->magic, MODEL_MAGIC, sizeof(header->magic)) == 0 &&
+    header->version == MODEL_VERSION && header->nr_att > 1 &&
+    header->nr_node > 0 && header->nr_node <= (1 << 30) &&
+    header->nr_att <= (1 << 20) &&
+    (header->width == sizeof(short) || header->width == sizeof(int)) &&
+    (header->numeric == 0 || header->numeric == 1) &&
+    header->nr_groups >= 0 && header->nr_groups <= (1 << 30) &&
+    (header->nr_groups == 0 || header->numeric == 1) &&
+    (size_t) st.st_size == sizeof(ModelHeader) + header->nr_att * sizeof(ATTVAL) +
+      2 * (size_t) header->nr_node * header->width +
+      (size_t) header->numeric * header->nr_node * sizeof(int) +
+      (size_t) header->nr_groups * sizeof(int);
+
+  FlatTree *flat = NULL;
+  if (good) {
+    flat = new FlatTree();
+    flat->map = map;
+    flat->map_size = st.st_size;
+    flat->nr_att = header->nr_att;
+    flat->nr_node = header->nr_node;
+    flat->attSizes = (ATTVAL*) ((char*) map + sizeof(ModelHeader));
+    char *nodes = (char*) (flat->attSizes + flat->nr_att);
+    if (header->width == sizeof(short))
+      flat->node16 = (short*) nodes;
+    else
+      flat->node32 = (int*) nodes;
+    if (header->numeric)
+      flat->thres = (int*) (nodes + 2 * (size_t) flat->nr_node * header->width);
+    if (header->nr_groups > 0) {
+      flat->groups = flat->thres + flat->nr_node;
+      flat->nr_groups = header->nr_groups;
+    }
+
+    // size 0 means continuous attr, but target must be nominal
+    for (ATTINDEX i = 0; good && i < flat->nr_att; i++)
+      good = flat->attSizes[i] > 0 || (flat->attSizes[i] == 0 && i < flat->nr_att - 1);
+    if (good && flat->node16)
+      good = flat_check(flat->node16, flat->thres, flat->groups, flat->nr_groups,
+        flat->nr_node, flat->attSizes, flat->nr_att);
+    else if (good)
+      good = flat_check(flat->node32, flat->thres, flat->groups, flat->nr_groups,
+        flat->nr_node, flat->attSizes, flat->nr_att);
+    if (!good) {
+      delete (flat); // unmaps file
+      flat = NULL;
+    }
+  } else {
+    munmap(map, st.st_size);
+  }
+
+  return flat;
+}
+
+/// @brief taking one step from inner node i
+/// @retval next node index ( -1 if row has invalid value )
+template <typename NODE>
+static inline int flat_step(const NODE *node, const int *thres, const int *groups,
+    const ATTVAL *attSizes, ATTINDEX nr_att, const ATTVAL *row, int i) {
+  int att = node[2 * i];
+  if (att >= 0) {
+    ATTVAL val = row[att];
+    // one unsigned compare rejects both negative and too large value
+    if ((unsigned) val >= (unsigned) attSizes[att])
+      return -1;
+    return node[2 * i + 1] + val;
+  }
+
+  att = -2 - att;
+  if (att < nr_att) // threshold test
+    return node[2 * i + 1] + (row[att] > thres[i]);
+
+  att -= nr_att; // grouping test
+  ATTVAL val = row[att];
+  if ((unsigned) val >= (unsigned) attSizes[att])
+    return -1;
+  return node[2 * i + 1] + groups[thres[i] + val];
+}
+
+/// @brief walking ( attr, link ) pairs from root to leaf
+template <typename NODE>
+static inline ATTVAL flat_walk(const NODE *node, const int *thres, const int *groups,
+    const ATTVAL *attSizes, ATTINDEX nr_att, const ATTVAL *attArray) {
+  int i = 0;
+  while (node[2 * i] != -1) {
+    i = flat_step(node, thres, groups, attSizes, nr_att, attArray, i);
+    if (i < 0)
+      return -1;
+  }
+  return node[2 * i + 1];
+}
+
+ATTVAL FlatTree::getVal(const ATTVAL *attArray) const {
+  if (node16)
+    return flat_walk(node16, thres, groups, attSizes, nr_att, attArray);
+  return flat_walk(node32, thres, groups, attSizes, nr_att, attArray);
+}
+
+#define FLAT_LANE 8 ///< the number of instances walked together
+
+/// @brief walking FLAT_LANE instances together, one level each in turn
+template <typename NODE>
+static void flat_walk_batch(const NODE *node, const int *thres, const int *groups,
+    const ATTVAL *attSizes, ATTINDEX nr_att, const ATTVAL *rows, int stride,
+    size_t n, ATTVAL *out) {
+  int cur[FLAT_LANE];
+
+  for (size_t base = 0; base < n; base += FLAT_LANE) {
+    int nr_lane = (n - base < FLAT_LANE) ? (int) (n - base) : FLAT_LANE;
+    for (int l = 0; l < nr_lane; l++)
+      cur[l] = 0;
+
+    int nr_active = nr_lane;
+    while (nr_active > 0) {
+      nr_active = 0;
+      for (int l = 0; l < nr_lane; l++) {
+        int i = cur[l];
+        if (i < 0) // finished lane
+          continue;
+        if (node[2 * i] == -1) {
+          out[base + l] = node[2 * i + 1];
+          cur[l] = -1;
+          continue;
+        }
+        cur[l] = flat_step(node, thres, groups, attSizes, nr_att,
+          rows + (base + l) * stride, i);
+        if (cur[l] < 0)
+          out[base + l] = -1;
+        else
+          nr_active++;
+      }
+    }
+  }
+}
+
+void FlatTree::getValBatch(const ATTVAL *rows, int stride, size_t n,
+    ATTVAL *out) const {
+  ASSERT (rows != NULL && out != NULL, (char*) "getValBatch condition error");
+  if (node16)
+    flat_walk_batch(node16, thres, groups, attSizes, nr_att, rows, stride, n, out);
+  else
+    flat_walk_batch(node32, thres, groups, attSizes, nr_att, rows, stride, n, out);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// DataSet class implementation
+///
+
+DataSet::DataSet(ATTINDEX nr_att, int nr_row, const ATTVAL *attSizes) {
+  ASSERT (nr_att > 1 && nr_row >= 0, (char*) "DataSet size error");
+  this->nr_att = nr_att;
+  this->nr_row = nr_row;
+
+  // the largest attr decides; continuous attr takes any value
+  bool narrow = (attSizes != NULL);
+  ATTVAL widest = 0;
+  for (ATTINDEX a = 0; narrow && a < nr_att; a++) {
+    if (attSizes[a] <= 0)
+      narrow = false;
+    else if (attSizes[a] > widest)
+      widest = attSizes[a];
+  }
+  data8 = NULL;
+  data16 = NULL;
+  data32 = NULL;
+  if (narrow && widest <= 256) {
+    width = sizeof(unsigned char);
+    data8 = new unsigned char[(long) nr_att * nr_row + 1];
+  } else if (narrow && widest <= 65536) {
+    width = sizeof(unsigned short);
+    data16 = new unsigned short[(long) nr_att * nr_row + 1];
+  } else {
+    width = sizeof(ATTVAL);
+    data32 = new ATTVAL[(long) nr_att * nr_row + 1];
+  }
+
+  nr_word = 0;
+  nr_valbit = 0;
+  bitOffset = NULL;
+  valBits = NULL;
+  classBits = NULL;
+}
+
+DataSet::~DataSet() {
+  if (data8)
+    delete [] data8;
+  if (data16)
+    delete [] data16;
+  if (data32)
+    delete [] data32;
+  if (bitOffset)
+    delete [] bitOffset;
+  if (valBits)
+    delete [] valBits;
+  if (classBits)
+    delete [] classBits;
+}
+
+ATTINDEX DataSet::getNrAtt() const {
+  return nr_att;
+}
+
+int DataSet::getNrRow() const {
+  return nr_row;
+}
+
+int DataSet::getWidth() const {
+  return width;
+}
+
+const void* DataSet::getColumn(ATTINDEX att) const {
+  ASSERT (att >= 0 && att < nr_att, (char*) "column index error");
+  long offset = (long) att * nr_row;
+  if (data8)
+    return data8 + offset;
+  if (data16)
+    return data16 + offset;
+  return data32 + offset;
+}
+
+ATTVAL DataSet::getVal(int row, ATTINDEX att) const {
+  long i = (long) att * nr_row + row;
+  if (data8)
+    return data8[i];
+  if (data16)
+    return data16[i];
+  return data32[i];
+}
+
+void DataSet::setVal(int row, ATTINDEX att, ATTVAL val) {
+  ASSERT (row >= 0 && row < nr_row && att >= 0 && att < nr_att,
+    (char*) "DataSet index error");
+  long i = (long) att * nr_row + row;
+  if (data8) {
+    ASSERT (val >= 0 && val <= 255, (char*) "value doesn't fit in 8 bits");
+    data8[i] = (unsigned char) val;
+  } else if (data16) {
+    ASSERT (val >= 0 && val <= 65535, (char*) "value doesn't fit in 16 bits");
+    data16[i] = (unsigned short) val;
+  } else
+    data32[i] = val;
+}
+
+#define BITMAP_MAX_VAL   64        ///< the maximum number of values of indexed attr
+
+bool DataSet::hasBitmap() const {
+  return valBits != NULL;
+}
+
+int DataSet::getBitOffset(ATTINDEX att) const {
+  return (bitOffset) ? bitOffset[att] : -1;
+}
+
+int DataSet::getNrValBit() const {
+  return nr_valbit;
+}
+
+const unsigned long long* DataSet::getValBits() const {
+  return valBits;
+}
+
+const unsigned long long* DataSet::getClassBits() const {
+  return classBits;
+}
+
+void DataSet::makeBitmap(const ATTVAL *attSizes) {
+  ASSERT (attSizes != NULL, (char*) "makeBitmap condition error");
+  if (valBits)
+    return;
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  bitOffset = new int[nr_att - 1];
+  nr_valbit = 0;
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+    bitOffset[a] = -1;
+    if (attSizes[a] <= 0 || attSizes[a] > BITMAP_MAX_VAL)
+      continue;
+    bitOffset[a] = nr_valbit;
+    nr_valbit += attSizes[a];
+  }
+
+  nr_word = (nr_row + 63) / 64;
+  valBits = new unsigned long long[(long) nr_word * nr_valbit + 1];
+  classBits = new unsigned long long[(long) nr_word * nr_class];
+  for (long i = 0; i < (long) nr_word * nr_valbit; i++)
+    valBits[i] = 0;
+  for (long i = 0; i < (long) nr_word * nr_class; i++)
+    classBits[i] = 0;
+
+  for (int r = 0; r < nr_row; r++)
+    classBits[(long) (r >> 6) * nr_class + getVal(r, nr_att - 1)] |= 1ULL << (r & 63);
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+    if (bitOffset[a] < 0)
+      continue;
+    for (int r = 0; r < nr_row; r++)
+      valBits[(long) (r >> 6) * nr_valbit + bitOffset[a] + getVal(r, a)] |= 1ULL << (r & 63);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 /// ID3 algorithm class implementation
 ///
 
-ID3::ID3(ATTVAL *attSizes, ATTINDEX nr_att, ATTVAL **train, ATTVAL **valid, int nr_train, int nr_valid) {
-  ASSERT (attSizes != NULL && nr_att > 1 && train != NULL &&
-          valid != NULL && nr_train > 0 && nr_valid > 0);
+void ID3::init() {
+  dtree = NULL;
+  attSizes = NULL;
+  nr_att = 0;
+  train = NULL;
+  valid = NULL;
+  tableOffset = NULL;
+  tableSize = 0;
+  rowIndex = NULL;
+  rowScratch = NULL;
+  sortedRows = NULL;
+  nr_bin = 0;
+  nrBins = NULL;
+  binCol = NULL;
+  binMap = NULL;
+  binEdge = NULL;
+  member = false;
+  sample = NULL;
+  nr_sample = 0;
+  nr_cand = 0;
+  seed = 0;
+  weight = NULL;
+  maxDepth = 0;
+  levelWise = false;
+  chiLevel = 0;
+  minRows = 0;
+  maxNodes = 0;
+  timeBudget = 0;
+  bitmap = false;
+  useBits = false;
+  trainMajor = -1;
+  flat = NULL;
+  nr_thread = 0;
+  pool = NULL;
+}
+
+void ID3::layoutTable() {
+  // count table layout ( attr x value x class ) except for target attr
+  tableOffset = new int[nr_att];
+  tableSize = 0;
+  for (ATTINDEX i = 0; i < nr_att - 1; i++) {
+    tableOffset[i] = tableSize;
+    tableSize += attSizes[i] * attSizes[nr_att - 1];
+  }
+  tableOffset[nr_att - 1] = tableSize;
+}
+
+ID3::ID3(ATTVAL *attSizes, ATTINDEX nr_att, DataSet *train, DataSet *valid) {
+  ASSERT (attSizes != NULL && nr_att > 1 && train != NULL && valid != NULL &&
+          train->getNrRow() > 0 && valid->getNrRow() > 0);
+  init();
   dtree = new DTree();
   this->attSizes = attSizes;
   dtree->setAttSizeArray(attSizes);
@@ -246,179 +980,1091 @@ ID3::ID3(ATTVAL *attSizes, ATTINDEX nr_att, ATTVAL **train, ATTVAL **valid, int
   dtree->setNrAtt(nr_att);
   this->train = train;
   this->valid = valid;
-  this->nr_train = nr_train;
-  this->nr_valid = nr_valid;
+  layoutTable();
+}
+
+ID3::ID3(FlatTree *flat) {
+  ASSERT (flat != NULL, (char*) "loaded model is NULL");
+  init();
+  nr_att = flat->getNrAtt();
+  this->flat = flat;
+}
+
+ID3::ID3(DTree *tree) {
+  ASSERT (tree != NULL && tree->getRoot() != NULL, (char*) "tree has no root");
+  init();
+  dtree = tree;
+  attSizes = tree->getAttSizeArray();
+  nr_att = tree->getNrAtt();
+  compile();
+}
+
+ID3::ID3(ATTVAL *attSizes, ATTINDEX nr_att, DataSet *train, WorkPool *pool) {
+  ASSERT (attSizes != NULL && nr_att > 1 && train != NULL && pool != NULL &&
+          train->getNrRow() > 0);
+  init();
+  // dtree owns its attSizes, so member tree gets a copy
+  ATTVAL *treeSizes = new ATTVAL[nr_att];
+  for (ATTINDEX i = 0; i < nr_att; i++)
+    treeSizes[i] = attSizes[i];
+  dtree = new DTree();
+  dtree->setAttSizeArray(treeSizes);
+  dtree->setNrAtt(nr_att);
+  this->attSizes = attSizes;
+  this->nr_att = nr_att;
+  this->train = train;
+  member = true;
+  this->pool = pool;
+  layoutTable();
 }
 
 ID3::~ID3() {
   if (dtree)
-    delete (dtree);
-
-  if (attSizes)
-    delete (attSizes);
+    delete (dtree); // attSizes is freed with dtree
 
-  if (train)
-    for (int i = 0; i < nr_train; i++)
-      if (train[i])
-        delete (train[i]);
-  delete (train);
+  if (train && !member)
+    delete (train);
   
   if (valid)
-    for (int i = 0; i < nr_valid; i++)
-      if (valid[i])
-        delete (valid[i]);
-  delete (valid);
+    delete (valid);
+
+  if (tableOffset)
+    delete [] tableOffset;
+
+  if (pool && !member)
+    delete (pool);
+
+  if (flat)
+    delete (flat);
+}
+
+DTree* ID3::getTree() const {
+  return dtree;
+}
+
+int ID3::getNrNode() const {
+  return (flat) ? flat->getNrNode() : 0;
+}
+
+bool ID3::save(const char *path) const {
+  if (!flat)
+    return false;
+  return flat->save(path);
+}
+
+void ID3::setNrThread(int nr_thread) {
+  this->nr_thread = nr_thread;
+  if (pool && !member) { // started again with the new count on next use
+    delete (pool);
+    pool = NULL;
+  }
+}
+
+WorkPool* ID3::getPool() {
+  // threads start on first parallel use, so setNrThread() never wastes them
+  if (!pool)
+    pool = new WorkPool(nr_thread);
+  return pool;
+}
+
+void ID3::setNrBin(int nr_bin) {
+  ASSERT (nr_bin == 0 || nr_bin >= 2, (char*) "histogram needs two bins at least");
+  this->nr_bin = nr_bin;
+}
+
+void ID3::setSample(int *sample, int nr_sample) {
+  ASSERT (sample != NULL && nr_sample > 0, (char*) "sample is empty");
+  this->sample = sample;
+  this->nr_sample = nr_sample;
+}
+
+void ID3::setWeight(double *weight) {
+  this->weight = weight;
+}
+
+void ID3::setLevelWise(bool levelWise) {
+  this->levelWise = levelWise;
+}
+
+void ID3::setMaxDepth(int maxDepth) {
+  ASSERT (maxDepth >= 0, (char*) "max depth is negative");
+  this->maxDepth = maxDepth;
+}
+
+void ID3::setSignificance(double chiLevel) {
+  ASSERT (chiLevel >= 0 && chiLevel < 1, (char*) "significance level is out of range");
+  this->chiLevel = chiLevel;
+}
+
+void ID3::setMinRows(int minRows) {
+  ASSERT (minRows >= 0, (char*) "minimum rows is negative");
+  this->minRows = minRows;
+}
+
+void ID3::setBudget(int maxNodes, int timeBudget) {
+  ASSERT (maxNodes >= 0 && timeBudget >= 0, (char*) "budget is negative");
+  this->maxNodes = maxNodes;
+  this->timeBudget = timeBudget;
+}
+
+void ID3::setBitmap(bool bitmap) {
+  this->bitmap = bitmap;
+}
+
+void ID3::setNrCand(int nr_cand, unsigned seed) {
+  ASSERT (nr_cand >= 0, (char*) "the number of candidates is negative");
+  this->nr_cand = nr_cand;
+  this->seed = seed;
+}
+
+/// @brief row order by value of one column ( row index breaks tie )
+struct ColumnLess {
+  const ATTVAL *col;    ///< column compared
+  ColumnLess(const ATTVAL *col) : col(col) {}
+  bool operator() (int a, int b) const {
+    return (col[a] != col[b]) ? col[a] < col[b] : a < b;
+  }
+};
+
+/// @brief value order by rate of the most common target value ( value breaks tie )
+struct RateLess {
+  const int *val_cnt;   ///< the number of rows of each value
+  const int *major_cnt; ///< the number of rows of each value having the common target
+  RateLess(const int *val_cnt, const int *major_cnt)
+    : val_cnt(val_cnt), major_cnt(major_cnt) {}
+  bool operator() (ATTVAL a, ATTVAL b) const {
+    // unseen value has rate 0
+    long long lhs = (long long) major_cnt[a] * ((val_cnt[b]) ? val_cnt[b] : 1);
+    long long rhs = (long long) major_cnt[b] * ((val_cnt[a]) ? val_cnt[a] : 1);
+    return (lhs != rhs) ? lhs < rhs : a < b;
+  }
+};
+
+void ID3::makeBins() {
+  int nr_train = train->getNrRow();
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  int bin_rows = (nr_bin > 0) ? (nr_train + nr_bin - 1) / nr_bin : 0;
+
+  nrBins = new ATTVAL[nr_att - 1];
+  binCol = new ATTVAL*[nr_att - 1];
+  binMap = new ATTVAL*[nr_att - 1];
+  binEdge = new ATTVAL*[nr_att - 1];
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+    nrBins[a] = 0;
+    binCol[a] = NULL;
+    binMap[a] = NULL;
+    binEdge[a] = NULL;
+    if (nr_bin <= 0 || (attSizes[a] != 0 && attSizes[a] <= nr_bin))
+      continue; // small nominal attr keeps multiway split
+
+    binCol[a] = new ATTVAL[nr_train];
+
+    if (attSizes[a] == 0) {
+      // a bin is closed at the first value change after bin_rows rows, so
+      // equal values never straddle bins and ( value <= edge ) means a prefix
+      ATTVAL *sorted = new ATTVAL[nr_train];
+      for (int i = 0; i < nr_train; i++)
+        sorted[i] = train->getVal(i, a);
+      sort(sorted, sorted + nr_train);
+
+      binEdge[a] = new ATTVAL[nr_bin];
+      int nr_in = 0;
+      for (int i = 0; i < nr_train; i++) {
+        nr_in++;
+        if (i == nr_train - 1 || (nr_in >= bin_rows && sorted[i] != sorted[i + 1])) {
+          binEdge[a][nrBins[a]++] = sorted[i];
+          nr_in = 0;
+        }
+      }
+      for (int i = 0; i < nr_train; i++)
+        binCol[a][i] = lower_bound(binEdge[a], binEdge[a] + nrBins[a],
+          train->getVal(i, a)) - binEdge[a];
+      delete [] sorted;
+      continue;
+    }
+
+    // nominal values have no order; line them up by how often they lead to
+    // the common target, then bin along that line like a continuous attr
+    int *val_cnt = new int[attSizes[a]];
+    int *major_cnt = new int[attSizes[a]];
+    ATTVAL *order = new ATTVAL[attSizes[a]];
+    for (ATTVAL v = 0; v < attSizes[a]; v++) {
+      val_cnt[v] = 0;
+      major_cnt[v] = 0;
+      order[v] = v;
+    }
+    for (int i = 0; i < nr_train; i++) {
+      ATTVAL val = train->getVal(i, a);
+      val_cnt[val]++;
+      if (train->getVal(i, nr_att - 1) == trainMajor)
+        major_cnt[val]++;
+    }
+    sort(order, order + attSizes[a], RateLess(val_cnt, major_cnt));
+
+    binMap[a] = new ATTVAL[attSizes[a]];
+    int nr_in = 0;
+    for (ATTVAL k = 0; k < attSizes[a]; k++) {
+      binMap[a][order[k]] = nrBins[a];
+      nr_in += val_cnt[order[k]];
+      if (nr_in >= bin_rows && nrBins[a] < nr_bin - 1 && k < attSizes[a] - 1) {
+        nrBins[a]++;
+        nr_in = 0;
+      }
+    }
+    nrBins[a]++;
+    for (int i = 0; i < nr_train; i++)
+      binCol[a][i] = binMap[a][train->getVal(i, a)];
+
+    delete [] val_cnt;
+    delete [] major_cnt;
+    delete [] order;
+  }
+
+  // count table layout again; binned attr has one entry per bin
+  tableSize = 0;
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+    tableOffset[a] = tableSize;
+    tableSize += ((binCol[a]) ? nrBins[a] : attSizes[a]) * nr_class;
+  }
+  tableOffset[nr_att - 1] = tableSize;
+}
+
+void ID3::freeBins() {
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+    if (binCol[a])
+      delete [] binCol[a];
+    if (binMap[a])
+      delete [] binMap[a];
+    if (binEdge[a])
+      delete [] binEdge[a];
+  }
+  delete [] nrBins;
+  delete [] binCol;
+  delete [] binMap;
+  delete [] binEdge;
+  nrBins = NULL;
+  binCol = NULL;
+  binMap = NULL;
+  binEdge = NULL;
 }
 
 void ID3::makeTree() {
+  ASSERT (train != NULL, (char*) "loaded model can't be trained");
   bool *remainAtt = new bool[nr_att - 1]; // except for target attr
-  for (int i = 0; i < nr_att; i++)
+  for (int i = 0; i < nr_att - 1; i++)
     remainAtt[i] = true; // means reamin
-  recursive_make_tree(NULL, 0, dtree, remainAtt, train, nr_train, 0, false, false); 
+
+  // one shared row index array; each node owns its [begin, end) range
+  int nr_train = (sample) ? nr_sample : train->getNrRow();
+  rowIndex = new int[nr_train];
+  rowScratch = new int[nr_train];
+  for (int i = 0; i < nr_train; i++)
+    rowIndex[i] = (sample) ? sample[i] : i;
+  trainMajor = majorClass(rowIndex, nr_train);
+  makeBins();
+
+  // continuous columns are sorted once unless binned; partitioning keeps
+  // them sorted
+  sortedRows = new int*[nr_att - 1];
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+    sortedRows[a] = NULL;
+    if (attSizes[a] != 0 || binCol[a])
+      continue;
+    sortedRows[a] = new int[nr_train];
+    for (int i = 0; i < nr_train; i++)
+      sortedRows[a][i] = rowIndex[i];
+    sort(sortedRows[a], sortedRows[a] + nr_train,
+      ColumnLess((const ATTVAL*) train->getColumn(a))); // 32-bit as continuous
+  }
+
+  // rows of every node stay ascending if training rows are; bitmap index
+  // of shared data set is made by its owner before members are trained
+  useBits = bitmap && !weight && bitmapSupported();
+  for (int i = 1; useBits && i < nr_train; i++)
+    if (rowIndex[i - 1] >= rowIndex[i])
+      useBits = false;
+  if (useBits && !member)
+    train->makeBitmap(attSizes);
+  useBits = useBits && train->hasBitmap();
+
+  if (maxNodes > 0 || timeBudget > 0)
+    best_make_tree(remainAtt);
+  else if (levelWise)
+    level_make_tree(remainAtt);
+  else
+    recursive_make_tree(NULL, 0, dtree, remainAtt, 0, nr_train, NULL, seed, 0); 
+
+  // printed after building since subtrees may be finished in any order
+  if (!member)
+    recursive_print_tree(dtree->getRoot(), 0, false, false);
+  compile();
+
+  delete [] rowIndex;
+  delete [] rowScratch;
+  rowIndex = NULL;
+  rowScratch = NULL;
+  for (ATTINDEX a = 0; a < nr_att - 1; a++)
+    if (sortedRows[a])
+      delete [] sortedRows[a];
+  delete [] sortedRows;
+  sortedRows = NULL;
+  freeBins();
+  useBits = false;
+  delete [] remainAtt;
 }
 
 void ID3::prune() {
+  ASSERT (valid != NULL, (char*) "loaded model can't be pruned");
   if (dynamic_cast <DTreeLeaf*> (dtree->getRoot()))
     return;
-  
-  ATTVAL *empty_path = new ATTVAL[nr_att];
-  for (int i = 0; i < nr_att; i++)
-    empty_path[i] = -1; // means empty (no index)
-  recursive_prune_tree(dtree->getRoot(), empty_path, valid, nr_valid);
+
+  int nr_valid = valid->getNrRow();
+  int *rows = new int[nr_valid + 1];
+  int *scratch = new int[nr_valid + 1];
+  for (int i = 0; i < nr_valid; i++)
+    rows[i] = i;
+
+  int nr_error = 0;
+  int nr_pruned = 0;
+  int nr_before = count_node(dtree->getRoot());
+  dtree->setRoot(recursive_prune_tree(dtree->getRoot(), rows, scratch, 0,
+    nr_valid, nr_error, nr_pruned));
+  delete [] rows;
+  delete [] scratch;
+
+  cout << "///      " << nr_pruned << " subtrees are pruned ( " << nr_before
+    << " -> " << count_node(dtree->getRoot()) << " nodes, " << nr_error << " / "
+    << nr_valid << " validation errors )" << endl;
+  compile();
 }
 
 ATTVAL ID3::predict(ATTVAL *input) {
   // it supposed that makeTree is already executed!
+  if (flat)
+    return flat->getVal(input);
   if (!dtree)
     return -1; // error
   
   return dtree->getLeaf(input)->getVal();
 }
 
+#define PREDICT_BLOCK (1 << 12) ///< rows per prediction task
+
+/// @brief argument of one prediction task; predicts one row block
+struct PredictArg {
+  ID3           *id3;     ///< ID3 engine
+  const ATTVAL  *rows;    ///< row block
+  size_t        n;        ///< the number of rows in block
+  ATTVAL        *out;     ///< prediction values of block
+};
+
+void ID3::predictTask(void *arg) {
+  PredictArg *t = (PredictArg*) arg;
+  t->id3->flat->getValBatch(t->rows, t->id3->nr_att - 1, t->n, t->out);
+}
+
+void ID3::predictBatch(const ATTVAL *rows, size_t n, ATTVAL *out) {
+  ASSERT (rows != NULL && out != NULL, (char*) "predictBatch condition error");
+  int stride = nr_att - 1;
 
-// check if data satisfy target array
-// ATTVAL -1 means unconditionally satisfaction
-static bool satisfaction(ATTVAL *dat, ATTVAL *target, ATTINDEX nr_att) {
-  ASSERT(dat != NULL && target != NULL && nr_att > 0,
-    (char*) "satisfaction condition error");
+  // it supposed that makeTree is already executed!
+  if (!flat) {
+    for (size_t i = 0; i < n; i++)
+      out[i] = (dtree) ? dtree->getLeaf((ATTVAL*) rows + i * stride)->getVal() : -1;
+    return;
+  }
 
-  bool ret = true;
-  for (int i = 0; i < nr_att; i++)
-    if (target[i] != -1 && dat[i] != target[i])
-      ret = false;
+  if (getPool()->getNrThread() <= 1 || n <= PREDICT_BLOCK) {
+    flat->getValBatch(rows, stride, n, out);
+    return;
+  }
 
-  return ret;
+  size_t nr_block = (n + PREDICT_BLOCK - 1) / PREDICT_BLOCK;
+  PredictArg *args = new PredictArg[nr_block];
+  TaskGroup group;
+  for (size_t b = 0; b < nr_block; b++) {
+    PredictArg *t = &args[b];
+    t->id3 = this;
+    t->rows = rows + b * PREDICT_BLOCK * stride;
+    t->n = (b == nr_block - 1) ? n - b * PREDICT_BLOCK : PREDICT_BLOCK;
+    t->out = out + b * PREDICT_BLOCK;
+    getPool()->spawn(&group, predictTask, t);
+  }
+  getPool()->wait(&group);
+  delete [] args;
 }
 
-int ID3::countInstance(ATTVAL *att_array, ATTVAL **examples, int nr_ex) {
-  ASSERT(att_array != NULL && examples != NULL, 
-    (char*) "att_array or example is NULL");
+void ID3::compile() {
+  if (flat)
+    delete (flat);
+  flat = new FlatTree(dtree);
+}
 
-  int count = 0;
+#define PARALLEL_CUTOFF  (1 << 14) ///< minimum ( rows x attrs ) counted in parallel
+#define ROW_BLOCK        (1 << 15) ///< rows per task when node rows are split
+
+/// @brief argument of one count task; counts one attribute on one row block
+struct CountArg {
+  ID3       *id3;         ///< ID3 engine
+  ATTINDEX  att;          ///< attribute to count
+  int       *rows;        ///< row block
+  int       nr_ex;        ///< the number of rows in block
+  double    *att_table;   ///< private attribute part of count table
+};
+
+/// @brief counting ( value x class ) of rows; column and target are as
+///        wide as data set, or column is 32-bit bins
+template <typename COL, typename VAL>
+static void count_rows(const COL *col, const VAL *target, const int *rows,
+    int nr_ex, ATTVAL nr_class, const double *weight, double *att_table) {
+  if (weight) {
+    for (int i = 0; i < nr_ex; i++)
+      att_table[col[rows[i]] * nr_class + target[rows[i]]] += weight[rows[i]];
+    return;
+  }
   for (int i = 0; i < nr_ex; i++)
-    if (satisfaction(examples[i], att_array, nr_att))
-      count++;
-  
-  return count;
+    att_table[col[rows[i]] * nr_class + target[rows[i]]]++;
+}
+
+/// @brief count_rows() on attr of data set or its bins
+template <typename VAL>
+static void count_column(const DataSet *set, ATTINDEX att, const ATTVAL *bin,
+    const int *rows, int nr_ex, ATTVAL nr_class, const double *weight,
+    double *att_table) {
+  const VAL *target = (const VAL*) set->getColumn(set->getNrAtt() - 1);
+  if (bin)
+    count_rows(bin, target, rows, nr_ex, nr_class, weight, att_table);
+  else
+    count_rows((const VAL*) set->getColumn(att), target, rows, nr_ex, nr_class,
+      weight, att_table);
 }
 
-double ID3::calEntropy(ATTVAL **examples, int nr_ex) {
-  if (examples == NULL)
+void ID3::countColumn(ATTINDEX att, int *rows, int nr_ex, double *att_table) {
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  if (train->getWidth() == sizeof(unsigned char))
+    count_column<unsigned char>(train, att, binCol[att], rows, nr_ex, nr_class,
+      weight, att_table);
+  else if (train->getWidth() == sizeof(unsigned short))
+    count_column<unsigned short>(train, att, binCol[att], rows, nr_ex, nr_class,
+      weight, att_table);
+  else
+    count_column<ATTVAL>(train, att, binCol[att], rows, nr_ex, nr_class,
+      weight, att_table);
+}
+
+void ID3::countTask(void *arg) {
+  CountArg *t = (CountArg*) arg;
+  t->id3->countColumn(t->att, t->rows, t->nr_ex, t->att_table);
+}
+
+/// @brief counting classes of rows
+template <typename VAL>
+static void count_class(const VAL *target, const int *rows, int nr_ex,
+    const double *weight, double *class_cnt) {
+  if (weight) {
+    for (int i = 0; i < nr_ex; i++)
+      class_cnt[target[rows[i]]] += weight[rows[i]];
+    return;
+  }
+  for (int i = 0; i < nr_ex; i++)
+    class_cnt[target[rows[i]]]++;
+}
+
+void ID3::countClass(int *rows, int nr_ex, double *class_cnt) {
+  for (ATTVAL c = 0; c < attSizes[nr_att - 1]; c++)
+    class_cnt[c] = 0;
+  const void *target = train->getColumn(nr_att - 1);
+  if (train->getWidth() == sizeof(unsigned char))
+    count_class((const unsigned char*) target, rows, nr_ex, weight, class_cnt);
+  else if (train->getWidth() == sizeof(unsigned short))
+    count_class((const unsigned short*) target, rows, nr_ex, weight, class_cnt);
+  else
+    count_class((const ATTVAL*) target, rows, nr_ex, weight, class_cnt);
+}
+
+#define BITMAP_SCAN      4         ///< cost of scanning one row of a column in quarter popcounts
+#define WORD_BLOCK       (1 << 10) ///< node bitmap words per task
+
+// word counting is built for hardware popcount whatever the build flags
+// are, and is only called where the CPU has it
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define POPCNT_TARGET    __attribute__((target("popcnt")))
+#else
+#define POPCNT_TARGET
+#endif
+
+bool ID3::bitmapSupported() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  return __builtin_cpu_supports("popcnt");
+#elif defined(__aarch64__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+/// @brief adding ( value, class ) popcounts of node words into cnt
+POPCNT_TARGET
+static void popcount_words(const unsigned long long *node, const int *word,
+    int n, const unsigned long long *valBits, int nr_valbit,
+    const unsigned long long *classBits, ATTVAL nr_class, const int *bit,
+    const int *entry, int nr_bit, int *cnt) {
+  for (int i = 0; i < n; i++) {
+    const unsigned long long *val_bits = valBits + (long) word[i] * nr_valbit;
+    const unsigned long long *class_bits = classBits + (long) word[i] * nr_class;
+    for (ATTVAL c = 0; c < nr_class; c++) {
+      unsigned long long in_class = node[i] & class_bits[c];
+      if (!in_class)
+        continue;
+      for (int b = 0; b < nr_bit; b++)
+        cnt[entry[b] + c] += __builtin_popcountll(in_class & val_bits[bit[b]]);
+    }
+  }
+}
+
+bool ID3::indexed(ATTINDEX att) const {
+  return train->getBitOffset(att) >= 0 && !binCol[att];
+}
+
+void ID3::countWords(const unsigned long long *node, const int *word, int n,
+    const ATTINDEX *att, int nr_idx, int *cnt) {
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  int nr_valbit = train->getNrValBit();
+
+  // ( attr, value ) bitmaps of a row word are adjacent, so indexed attrs
+  // are laid out as one run of bitmaps and count table entries
+  int nr_bit = 0;
+  for (int k = 0; k < nr_idx; k++)
+    nr_bit += attSizes[att[k]];
+  int *bit = new int[nr_bit];
+  int *entry = new int[nr_bit];
+  int b = 0;
+  for (int k = 0; k < nr_idx; k++) {
+    ATTINDEX a = att[k];
+    for (ATTVAL v = 0; v < attSizes[a]; v++, b++) {
+      bit[b] = train->getBitOffset(a) + v;
+      entry[b] = tableOffset[a] + v * nr_class;
+    }
+  }
+
+  popcount_words(node, word, n, train->getValBits(), nr_valbit,
+    train->getClassBits(), nr_class, bit, entry, nr_bit, cnt);
+
+  delete [] bit;
+  delete [] entry;
+}
+
+/// @brief argument of one bitmap count task; counts one block of node words
+struct WordArg {
+  ID3                       *id3;   ///< ID3 engine
+  const unsigned long long  *node;  ///< node bitmap words of block
+  const int                 *word;  ///< row word index of each node word
+  int                       n;      ///< the number of node words in block
+  const ATTINDEX            *att;   ///< indexed attrs to count
+  int                       nr_idx; ///< the number of attrs in att
+  int                       *cnt;   ///< private count table of block
+};
+
+void ID3::wordTask(void *arg) {
+  WordArg *t = (WordArg*) arg;
+  t->id3->countWords(t->node, t->word, t->n, t->att, t->nr_idx, t->cnt);
+}
+
+bool ID3::countBitmap(bool *remainAtt, int *rows, int nr_ex, double *table) {
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  ATTINDEX *att = new ATTINDEX[nr_att - 1];
+  int nr_idx = 0;
+  long nr_bit = 0;
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+    if (!remainAtt[a] || !indexed(a))
+      continue;
+    att[nr_idx++] = a;
+    nr_bit += attSizes[a];
+  }
+
+  // popcounts per node word against row scans; before gathering words,
+  // their number is expected from rows spread evenly over their word span
+  long scan_cost = (long) nr_ex * nr_idx * BITMAP_SCAN;
+  long word_cost = (long) nr_class * (nr_bit + 1) * 4;
+  double span = (nr_ex > 0) ? (rows[nr_ex - 1] >> 6) - (rows[0] >> 6) + 1 : 0;
+  double expect = (nr_ex > 0) ? span * (1 - pow(1 - nr_ex / (span * 64), 64)) : 0;
+  if (nr_idx == 0 || expect * word_cost >= scan_cost) {
+    delete [] att;
+    return false;
+  }
+
+  // ascending rows make words of node in order
+  int nr_word = (train->getNrRow() + 63) / 64;
+  int max_word = (nr_ex < nr_word) ? nr_ex : nr_word;
+  unsigned long long *node = new unsigned long long[max_word];
+  int *word = new int[max_word];
+  int n = 0;
+  for (int i = 0; i < nr_ex; i++) {
+    int w = rows[i] >> 6;
+    if (n == 0 || word[n - 1] != w) {
+      word[n] = w;
+      node[n++] = 0;
+    }
+    node[n - 1] |= 1ULL << (rows[i] & 63);
+  }
+  if ((long) n * word_cost >= scan_cost) {
+    delete [] node;
+    delete [] word;
+    delete [] att;
+    return false;
+  }
+
+  // one task per word block, each with its own count table
+  int nr_block = (n + WORD_BLOCK - 1) / WORD_BLOCK;
+  if (nr_block > getPool()->getNrThread())
+    nr_block = getPool()->getNrThread();
+  if (nr_block < 1)
+    nr_block = 1;
+  int block_size = (n + nr_block - 1) / nr_block;
+  int *cnt = new int[nr_block * tableSize];
+  for (int i = 0; i < nr_block * tableSize; i++)
+    cnt[i] = 0;
+  if (nr_block == 1)
+    countWords(node, word, n, att, nr_idx, cnt);
+  else {
+    WordArg *args = new WordArg[nr_block];
+    TaskGroup group;
+    for (int b = 0; b < nr_block; b++) {
+      int b_begin = b * block_size;
+      int b_end = (b_begin + block_size < n) ? b_begin + block_size : n;
+      WordArg *t = &args[b];
+      t->id3 = this;
+      t->node = node + b_begin;
+      t->word = word + b_begin;
+      t->n = (b_end > b_begin) ? b_end - b_begin : 0;
+      t->att = att;
+      t->nr_idx = nr_idx;
+      t->cnt = cnt + b * tableSize;
+      getPool()->spawn(&group, wordTask, t);
+    }
+    getPool()->wait(&group);
+    delete [] args;
+  }
+
+  for (int k = 0; k < nr_idx; k++)
+    for (int i = tableOffset[att[k]]; i < tableOffset[att[k] + 1]; i++)
+      for (int b = 0; b < nr_block; b++)
+        table[i] += cnt[b * tableSize + i];
+
+  delete [] cnt;
+  delete [] node;
+  delete [] word;
+  delete [] att;
+  return true;
+}
+
+void ID3::countTable(bool *remainAtt, int *rows, int nr_ex, double *table,
+    double *class_cnt) {
+  ASSERT(remainAtt != NULL && rows != NULL && table != NULL && class_cnt != NULL,
+    (char*) "countTable condition error");
+
+  for (int i = 0; i < tableSize; i++)
+    table[i] = 0;
+  countClass(rows, nr_ex, class_cnt);
+
+  // swept continuous attrs are not counted here ( see sweepColumn() ), nor
+  // indexed attrs counted by bitmap
+  bool bits = useBits && countBitmap(remainAtt, rows, nr_ex, table);
+  bool *scan = new bool[nr_att - 1];
+  int nr_remain = 0;
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+    scan[a] = remainAtt[a] && !sortedRows[a] && !(bits && indexed(a));
+    if (scan[a])
+      nr_remain++;
+  }
+
+  // small node; one linear scan per remaining column
+  if (getPool()->getNrThread() <= 1 || (long) nr_ex * nr_remain < PARALLEL_CUTOFF) {
+    for (ATTINDEX a = 0; a < nr_att - 1; a++)
+      if (scan[a])
+        countColumn(a, rows, nr_ex, table + tableOffset[a]);
+    delete [] scan;
+    return;
+  }
+
+  // large node; one task per ( attribute, row block ), and each row block
+  // has its own count table which is summed up after all tasks finish
+  // weights are summed in row order regardless of threads ( no row blocks )
+  int nr_block = (nr_ex + ROW_BLOCK - 1) / ROW_BLOCK;
+  if (nr_block > getPool()->getNrThread())
+    nr_block = getPool()->getNrThread();
+  if (weight)
+    nr_block = 1;
+  int block_size = (nr_ex + nr_block - 1) / nr_block;
+
+  double *partial = (nr_block > 1) ? new double[nr_block * tableSize] : table;
+  for (int i = 0; nr_block > 1 && i < nr_block * tableSize; i++)
+    partial[i] = 0;
+
+  CountArg *args = new CountArg[nr_remain * nr_block];
+  TaskGroup group;
+  int nr_task = 0;
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+    if (!scan[a])
+      continue;
+    for (int b = 0; b < nr_block; b++) {
+      int b_begin = b * block_size;
+      int b_end = (b_begin + block_size < nr_ex) ? b_begin + block_size : nr_ex;
+      CountArg *t = &args[nr_task++];
+      t->id3 = this;
+      t->att = a;
+      t->rows = rows + b_begin;
+      t->nr_ex = (b_end > b_begin) ? b_end - b_begin : 0;
+      t->att_table = partial + b * tableSize + tableOffset[a];
+      getPool()->spawn(&group, countTask, t);
+    }
+  }
+  getPool()->wait(&group);
+
+  if (nr_block > 1) {
+    for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+      if (!scan[a])
+        continue;
+      for (int i = tableOffset[a]; i < tableOffset[a + 1]; i++)
+        for (int b = 0; b < nr_block; b++)
+          table[i] += partial[b * tableSize + i];
+    }
+    delete [] partial;
+  }
+  delete [] args;
+  delete [] scan;
+}
+
+double ID3::calEntropy(double *class_cnt, double nr_ex) {
+  if (class_cnt == NULL || nr_ex <= 0)
     return 0;
 
   double entropy = 0;
   
-  ATTVAL *tmp_array = new ATTVAL[nr_att];
-  for (ATTINDEX i = 0; i < nr_att; i++)
-    tmp_array[i] = -1;
   for (ATTVAL i = 0; i < attSizes[nr_att-1]; i++) {
-    tmp_array[nr_att-1] = i;
-    
-    double p = ((double)countInstance(tmp_array, examples, nr_ex)) / ((double)nr_ex);
+    if (class_cnt[i] <= 0)
+      continue; // 0 * log(0) is regarded as 0 ( below 0 is rounding error )
+    double p = ((double)class_cnt[i]) / ((double)nr_ex);
     entropy += -p * log(p) / log((double)2);
   }
-  //delete (tmp_array);
 
   return entropy;
 }
 
-double ID3::calGain(ATTINDEX att, ATTVAL **examples, int nr_ex) {
-  ASSERT(att >= 0 && att < nr_att - 1 && examples != NULL && nr_ex > 0,
+double ID3::calGain(ATTINDEX att, double *table, double *class_cnt, double nr_ex) {
+  ASSERT(att >= 0 && att < nr_att - 1 && table != NULL && nr_ex > 0,
     (char*) "calGain condition error");
   
+  ATTVAL nr_class = attSizes[nr_att - 1];
   double gain = 0;
   
-  gain += calEntropy(examples, nr_ex);
+  gain += calEntropy(class_cnt, nr_ex);
 
   for (ATTVAL i = 0; i < attSizes[att]; i++) {
-    int nr_tmp_exam;
-    ATTVAL **tmp_exam = makeNewExam(examples, nr_ex, att, i, nr_tmp_exam);
-    gain -= ((double)nr_tmp_exam / (double)nr_ex) * calEntropy(tmp_exam, nr_tmp_exam);
+    double *val_cnt = table + tableOffset[att] + i * nr_class;
+    double nr_val = 0;
+    for (ATTVAL c = 0; c < nr_class; c++)
+      nr_val += val_cnt[c];
+    gain -= ((double)nr_val / (double)nr_ex) * calEntropy(val_cnt, nr_val);
   }
   
   return gain;  
 }
 
-ATTINDEX ID3::takeBestAtt(bool *remainAtt, ATTVAL **examples, int nr_ex) {
-  ASSERT(remainAtt != NULL && examples != NULL && nr_ex > 0,
+bool ID3::binGain(ATTINDEX att, double *table, double *class_cnt, double nr_ex,
+    double &gain, ATTVAL &cut) {
+  ASSERT (att >= 0 && att < nr_att - 1 && binCol[att] != NULL && table != NULL &&
+    class_cnt != NULL, (char*) "binGain condition error");
+
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  double *att_table = table + tableOffset[att];
+  double entropy = calEntropy(class_cnt, nr_ex);
+
+  // the last bin having rows; right side is empty from there on, which
+  // is decided exactly even if weighted sums are rounded
+  ATTVAL last = -1;
+  for (ATTVAL b = 0; b < nrBins[att]; b++)
+    for (ATTVAL c = 0; c < nr_class; c++)
+      if (att_table[b * nr_class + c] > 0)
+        last = b;
+
+  // left side grows by one bin at a time; right side is the rest
+  double *left = new double[nr_class];
+  double *right = new double[nr_class];
+  for (ATTVAL c = 0; c < nr_class; c++) {
+    left[c] = 0;
+    right[c] = class_cnt[c];
+  }
+
+  bool found = false;
+  double nr_left = 0;
+  for (ATTVAL b = 0; b < last; b++) {
+    double *bin_cnt = att_table + b * nr_class;
+    for (ATTVAL c = 0; c < nr_class; c++) {
+      left[c] += bin_cnt[c];
+      right[c] -= bin_cnt[c];
+      nr_left += bin_cnt[c];
+    }
+    if (nr_left <= 0)
+      continue; // left side is empty
+
+    double nr_right = nr_ex - nr_left;
+    double curGain = entropy -
+      (nr_left / nr_ex) * calEntropy(left, nr_left) -
+      (nr_right / nr_ex) * calEntropy(right, nr_right);
+    if (!found || curGain > gain) {
+      found = true;
+      gain = curGain;
+      cut = b;
+    }
+  }
+
+  delete [] left;
+  delete [] right;
+
+  return found;
+}
+
+bool ID3::sweepColumn(ATTINDEX att, int begin, int end, double *class_cnt,
+    double &gain, ATTVAL &threshold) {
+  ASSERT (att >= 0 && att < nr_att - 1 && attSizes[att] == 0 && class_cnt != NULL &&
+    train->getWidth() == sizeof(ATTVAL), (char*) "sweepColumn condition error");
+
+  // continuous attr makes data set 32-bit
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  const ATTVAL *target = (const ATTVAL*) train->getColumn(nr_att - 1);
+  const ATTVAL *col = (const ATTVAL*) train->getColumn(att);
+  int *sorted = sortedRows[att];
+  double nr_ex = 0;
+  for (ATTVAL c = 0; c < nr_class; c++)
+    nr_ex += class_cnt[c];
+  double entropy = calEntropy(class_cnt, nr_ex);
+
+  // left side grows while sweeping; right side is the rest
+  double *left = new double[nr_class];
+  double *right = new double[nr_class];
+  for (ATTVAL c = 0; c < nr_class; c++) {
+    left[c] = 0;
+    right[c] = class_cnt[c];
+  }
+
+  bool found = false;
+  double nr_left = 0;
+  for (int i = begin; i < end - 1; i++) {
+    double w = (weight) ? weight[sorted[i]] : 1;
+    left[target[sorted[i]]] += w;
+    right[target[sorted[i]]] -= w;
+    nr_left += w;
+    if (col[sorted[i]] == col[sorted[i + 1]])
+      continue; // not a boundary
+
+    double nr_right = nr_ex - nr_left;
+    double curGain = entropy -
+      (nr_left / nr_ex) * calEntropy(left, nr_left) -
+      (nr_right / nr_ex) * calEntropy(right, nr_right);
+    if (!found || curGain > gain) {
+      found = true;
+      gain = curGain;
+      threshold = col[sorted[i]];
+    }
+  }
+
+  delete [] left;
+  delete [] right;
+
+  return found;
+}
+
+/// @brief argument of one sweep task; finds threshold of one continuous attr
+struct SweepArg {
+  ID3       *id3;         ///< ID3 engine
+  ATTINDEX  att;          ///< continuous attribute to sweep
+  int       begin;        ///< the first position of current examples
+  int       end;          ///< the next position of the last current example
+  double    *class_cnt;   ///< class count array of current examples
+  double    gain;         ///< best gain
+  ATTVAL    threshold;    ///< best threshold
+  bool      found;        ///< true if there is a boundary
+};
+
+void ID3::sweepTask(void *arg) {
+  SweepArg *t = (SweepArg*) arg;
+  t->found = t->id3->sweepColumn(t->att, t->begin, t->end, t->class_cnt,
+    t->gain, t->threshold);
+}
+
+ATTINDEX ID3::takeBestAtt(bool *remainAtt, int begin, int end, double *table,
+    ATTVAL &threshold, double *gain) {
+  ASSERT(remainAtt != NULL && begin < end && table != NULL,
     (char*) "takeBestAtt condition error");
 
+  int nr_row = end - begin;
+  double *class_cnt = table + tableSize;
+  double nr_ex = 0; // weighted
+  for (ATTVAL c = 0; c < attSizes[nr_att - 1]; c++)
+    nr_ex += class_cnt[c];
+
+  // unbinned continuous attrs are swept over their presorted rows
+  int nr_cont = 0;
+  for (ATTINDEX i = 0; i < nr_att - 1; i++)
+    if (remainAtt[i] && sortedRows[i])
+      nr_cont++;
+  SweepArg *sweeps = new SweepArg[nr_cont + 1];
+  TaskGroup group;
+  bool parallel = getPool()->getNrThread() > 1 && (long) nr_row * nr_cont >= PARALLEL_CUTOFF;
+  for (ATTINDEX i = 0, k = 0; i < nr_att - 1; i++) {
+    if (!remainAtt[i] || !sortedRows[i])
+      continue;
+    SweepArg *t = &sweeps[k++];
+    t->id3 = this;
+    t->att = i;
+    t->begin = begin;
+    t->end = end;
+    t->class_cnt = class_cnt;
+    if (parallel)
+      getPool()->spawn(&group, sweepTask, t);
+    else
+      sweepTask(t);
+  }
+  getPool()->wait(&group);
+
+  // gains are taken in attribute order, so the lowest index wins a tie
+  // regardless of how counting is scheduled
   ATTINDEX best = -1;
-  double max_gain;
+  double max_gain = 0;
 
-  for (ATTINDEX i = 0; i < nr_att - 1; i++) {
+  for (ATTINDEX i = 0, k = 0; i < nr_att - 1; i++) {
     if (remainAtt[i] == true) {
-      if (best == -1) {
-        best = i;
-        max_gain = calGain(i, examples, nr_ex);
-        continue;
+      double curGain;
+      ATTVAL curThreshold = 0;
+      if (sortedRows[i]) {
+        SweepArg *t = &sweeps[k++];
+        if (!t->found)
+          continue; // every row has the same value
+        curGain = t->gain;
+        curThreshold = t->threshold;
+      } else if (binCol[i]) {
+        ATTVAL cut = 0;
+        if (!binGain(i, table, class_cnt, nr_ex, curGain, cut))
+          continue; // every row is in the same bin
+        curThreshold = (attSizes[i] == 0) ? binEdge[i][cut] : cut;
+      } else {
+        curGain = calGain(i, table, class_cnt, nr_ex);
       }
-      
-      double curGain = calGain(i, examples, nr_ex);
-      if (curGain > max_gain) {
+
+      if (best == -1 || curGain > max_gain) {
         max_gain = curGain;
         best = i;
+        threshold = curThreshold;
       }
     }
   }
+
+  delete [] sweeps;
+  if (gain && best != -1)
+    *gain = max_gain;
   
   return best;
 }
 
-ATTVAL** ID3::makeNewExam(ATTVAL **src, int nr_src, ATTINDEX att, ATTVAL val, 
-    int &nr_dst) {
-  ASSERT(src != NULL && nr_src > 0 && att >= 0 && att < nr_att &&
-    val >= 0 && val < attSizes[att], (char*) "makeNewExam condition error");
-  
-  ATTVAL **ret;
-  // first, count wanted examples to allocate destination array mem
-  int cnt_target = 0;
-  for (int i = 0; i < nr_src; i++)
-    if (src[i][att] == val)
-      cnt_target++;
-  
-  nr_dst = cnt_target;
-  if (cnt_target == 0)
+bool* ID3::drawAtt(bool *remainAtt, unsigned &state) {
+  int nr_remain = 0;
+  for (ATTINDEX a = 0; a < nr_att - 1; a++)
+    if (remainAtt[a])
+      nr_remain++;
+  if (nr_cand <= 0 || nr_remain <= nr_cand)
     return NULL;
 
-  // second, allocate destination array and fill it
-  ret = new ATTVAL*[cnt_target];
-  int index_dst = 0;
-  for (int i = 0; i < nr_src; i++)
-    if (src[i][att] == val)
-      ret[index_dst++] = src[i];
- 
-  return ret;
+  // partial shuffle of remaining attrs; the first nr_cand are drawn
+  ATTINDEX *order = new ATTINDEX[nr_remain];
+  for (ATTINDEX a = 0, k = 0; a < nr_att - 1; a++)
+    if (remainAtt[a])
+      order[k++] = a;
+  bool *candAtt = new bool[nr_att - 1];
+  for (ATTINDEX a = 0; a < nr_att - 1; a++)
+    candAtt[a] = false;
+  for (int k = 0; k < nr_cand; k++) {
+    int pick = k + rand_r(&state) % (nr_remain - k);
+    ATTINDEX tmp = order[k];
+    order[k] = order[pick];
+    order[pick] = tmp;
+    candAtt[order[k]] = true;
+  }
+  delete [] order;
+
+  return candAtt;
 }
 
-static void print_tree_entry(int indent, bool first, bool last, int val, bool leaf)
+ATTVAL ID3::majorClass(int *rows, int nr_ex) {
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  double *class_cnt = new double[nr_class];
+  countClass(rows, nr_ex, class_cnt);
+
+  double maxCnt = 0;
+  ATTVAL maxVal = -1;
+  for (ATTVAL c = 0; c < nr_class; c++) {
+    if (maxCnt < class_cnt[c]) {
+      maxCnt = class_cnt[c];
+      maxVal = c;
+    }
+  }
+  delete [] class_cnt;
+
+  return maxVal;
+}
+
+/// @brief counting sort of row range by child of node on its column
+template <typename VAL>
+static void partition_rows(const VAL *col, int *rows, int *scratch,
+    DTreeRoot *node, int begin, int end, int *child_begin) {
+  ATTVAL nr_child = node->getNrChild();
+
+  // counting sort; first, count each child right after its start position
+  for (ATTVAL v = 0; v <= nr_child; v++)
+    child_begin[v] = 0;
+  for (int i = begin; i < end; i++)
+    child_begin[node->getBranch(col[rows[i]]) + 1]++;
+  child_begin[0] = begin;
+  for (ATTVAL v = 1; v <= nr_child; v++)
+    child_begin[v] += child_begin[v - 1];
+
+  // second, scatter rows using child_begin as cursors ( keeps row order )
+  for (int i = begin; i < end; i++)
+    scratch[child_begin[node->getBranch(col[rows[i]])]++] = rows[i];
+  for (int i = begin; i < end; i++)
+    rows[i] = scratch[i];
+
+  // cursors now point the end of each range; shift them back
+  for (ATTVAL v = nr_child; v > 0; v--)
+    child_begin[v] = child_begin[v - 1];
+  child_begin[0] = begin;
+}
+
+void ID3::partition(DataSet *set, int *rows, int *scratch, DTreeRoot *node,
+    int begin, int end, int *child_begin) {
+  ASSERT (set != NULL && rows != NULL && scratch != NULL && node != NULL &&
+    child_begin != NULL, (char*) "partition condition error");
+
+  const void *col = set->getColumn(node->getAttIndex());
+  if (set->getWidth() == sizeof(unsigned char))
+    partition_rows((const unsigned char*) col, rows, scratch, node, begin, end,
+      child_begin);
+  else if (set->getWidth() == sizeof(unsigned short))
+    partition_rows((const unsigned short*) col, rows, scratch, node, begin, end,
+      child_begin);
+  else
+    partition_rows((const ATTVAL*) col, rows, scratch, node, begin, end,
+      child_begin);
+}
+
+static void print_tree_entry(int indent, bool first, bool last, int val, bool leaf,
+  bool numeric = false, int threshold = 0, int nr_first = 0, int nr_value = 0)
 {
   char lBrac = (leaf) ? '{' : '(';
   char rBrac = (leaf) ? '}' : ')';
   if (indent != 0) {
     if (first) {
       cout << " - ";
-      cout << lBrac << val << rBrac;
     } else {
       cout << endl << "///\t   ";
       for (int i = 0; i < indent - 1; i++)
@@ -427,221 +2073,823 @@ static void print_tree_entry(int indent, bool first, bool last, int val, bool le
         cout << " \\ ";
       else
         cout << " + ";
-      cout << lBrac << val << rBrac;
     }
   } else {
-    cout << "///\t" << lBrac << val << rBrac;
+    cout << "///\t";
   }
+  cout << lBrac << val;
+  if (numeric) // threshold test; first child is value <= threshold
+    cout << "<=" << threshold;
+  else if (nr_value > 0) // grouping test; nr_first values go to first child
+    cout << ":" << nr_first << "/" << nr_value;
+  cout << rBrac;
 }
 
-void ID3::recursive_make_tree(DTreeRoot *parent, int ch_index, DTree *tree, 
-    bool *remainAtt, ATTVAL **cur_ex, int nr_cur_ex, int indent, bool first,
-    bool last) {
-  // step 0. condition check
-  ASSERT (remainAtt != NULL, (char*) "remainAtt is NULL");
-  if (cur_ex != NULL && nr_cur_ex > 0)
-    for (int i = 0; i < nr_cur_ex; i++)
-      ASSERT (cur_ex[i] != NULL, (char*) "cur_ex entry is NULL");
-  
-  if (cur_ex)
-  {
-    // step 1. check if all train data have same value => make leaf
-    bool same = true;
-    // first train value (last attribute is target attr)
-    ATTVAL same_val = cur_ex[0][nr_att-1];     
-    for (int i = 0; i < nr_cur_ex; i++) {
-      if (cur_ex[i][nr_att-1] != same_val) {
-        same = false;
-        break;
-      }
+#define SUBTREE_CUTOFF  (1 << 12) ///< minimum rows of a child subtree built as a task
+
+/// @brief argument of one subtree task; builds one child of parent
+struct BuildArg {
+  ID3       *id3;         ///< ID3 engine
+  DTreeRoot *parent;      ///< parent node which child hangs off
+  int       ch_index;     ///< child index in parent
+  bool      *remainAtt;   ///< private copy of remain attribute flags
+  int       begin;        ///< the first position of child range in rowIndex
+  int       end;          ///< the next position of the last one in range
+  double    *table;       ///< count table of child range ( NULL if not counted )
+  unsigned  seed;         ///< random seed of child
+  int       depth;        ///< depth of child
+};
+
+void ID3::buildTask(void *arg) {
+  BuildArg *t = (BuildArg*) arg;
+  t->id3->recursive_make_tree(t->parent, t->ch_index, NULL, t->remainAtt,
+    t->begin, t->end, t->table, t->seed, t->depth);
+}
+
+ATTVAL ID3::leafValue(bool *remainAtt, int begin, int end, int depth) {
+  int *cur_ex = rowIndex + begin;
+  int nr_cur_ex = end - begin;
+
+  // step 3. check if there is no example => make leaf as common val
+  if (nr_cur_ex == 0)
+    return trainMajor;
+
+  // step 1. check if all train data have same value => make leaf
+  bool same = true;
+  // first train value (last attribute is target attr)
+  ATTVAL same_val = train->getVal(cur_ex[0], nr_att - 1);
+  for (int i = 0; i < nr_cur_ex; i++) {
+    if (train->getVal(cur_ex[i], nr_att - 1) != same_val) {
+      same = false;
+      break;
     }
+  }
 
-    if (same) {
-      if (!parent) { // Root node
-        if (tree) {
-          dtree->setRoot(new DTreeLeaf(same_val));
-          print_tree_entry(indent, first, last, same_val, true);
-          return;
-        } else { // error
-          cout << "ERROR: Root node must have tree info" << endl;
-          exit(1);
-        }
-      } else { // leaf node
-        if (ch_index >= 0 && ch_index <= attSizes[parent->getAttIndex()]) {
-          parent->setOneChild(new DTreeLeaf(same_val), ch_index);
-          print_tree_entry(indent, first, last, same_val, true);
-          return;
-        } else {
-          cout << "ERROR: ch_index is invalid" << endl;
-          exit(1);
-        }
-      }
+  // step 2. check if att num is 0 except for target attr => make leaf
+  int nr_remain_att = 0;
+  for (int i = 0; i < nr_att - 1; i++)
+    if (remainAtt[i])
+      nr_remain_att++;
+
+  if (same)
+    return same_val;
+  else if (nr_remain_att == 0) // only attr is target
+    return majorClass(cur_ex, nr_cur_ex);
+  else if (maxDepth > 0 && depth >= maxDepth) // deep enough
+    return majorClass(cur_ex, nr_cur_ex);
+  else if (nr_cur_ex < minRows) // too few rows to split
+    return majorClass(cur_ex, nr_cur_ex);
+  return -1;
+}
+
+ATTINDEX ID3::chooseAtt(bool *remainAtt, int begin, int end, double *table,
+    unsigned &seed, ATTVAL &threshold, double *gain) {
+  // random attr subset if drawn; all remaining attrs if none of it splits
+  ATTINDEX best = -1;
+  bool *candAtt = drawAtt(remainAtt, seed);
+  if (candAtt)
+    best = takeBestAtt(candAtt, begin, end, table, threshold, gain);
+  if (best == -1)
+    best = takeBestAtt(remainAtt, begin, end, table, threshold, gain);
+  if (candAtt)
+    delete [] candAtt;
+  return best;
+}
+
+DTreeNode* ID3::makeNode(ATTVAL leaf_val, ATTINDEX best, ATTVAL threshold,
+    int begin, int end) {
+  int *cur_ex = rowIndex + begin;
+  int nr_cur_ex = end - begin;
+
+  if (best == -1)
+    return new DTreeLeaf((leaf_val >= 0) ? leaf_val : majorClass(cur_ex, nr_cur_ex));
+
+  bool binary = attSizes[best] == 0 || binCol[best];
+  ATTVAL nr_child = (binary) ? 2 : attSizes[best];
+  DTreeNode **child = new DTreeNode*[nr_child];
+  for (ATTVAL i = 0; i < nr_child; i++) // a test node may be dropped before children
+    child[i] = NULL;
+  DTreeRoot *cur = new DTreeRoot(best, child, nr_child);
+  cur->setMajor(majorClass(cur_ex, nr_cur_ex)); // for pruning
+  if (attSizes[best] == 0) {
+    cur->setThreshold(threshold);
+  } else if (binCol[best]) { // bins after the cut go to second child
+    ATTVAL *group = new ATTVAL[attSizes[best]];
+    for (ATTVAL v = 0; v < attSizes[best]; v++)
+      group[v] = (binMap[best][v] > threshold) ? 1 : 0;
+    cur->setGroup(group, attSizes[best]);
+  }
+  return cur;
+}
+
+/// @brief upper tail probability of chi-square distribution
+/// @details regularized incomplete gamma Q( df / 2, stat / 2 ); series for @n
+///          small stat, continued fraction otherwise ( Numerical Recipes )
+static double chiSquareTail(double stat, int df) {
+  if (stat <= 0)
+    return 1;
+  double a = df / 2.0;
+  double x = stat / 2.0;
+  double front = exp(-x + a * log(x) - lgamma(a));
+
+  if (x < a + 1) { // lower part by series
+    double term = 1.0 / a;
+    double sum = term;
+    for (int n = 1; n < 1000 && term > sum * 1e-15; n++) {
+      term *= x / (a + n);
+      sum += term;
     }
+    return 1 - sum * front;
+  }
 
-    // step 2. check if att num is 0 except for target attr => make leaf
-    int nr_remain_att = 0;
-    for (int i = 0; i < nr_att - 1; i++)
-      if (remainAtt[i])
-        nr_remain_att++;
-
-    if (nr_remain_att == 0) { // only attr is target
-      ATTVAL *att_array = new ATTVAL[nr_att];
-      for (int i = 0; i < nr_att - 1; i++)
-        att_array[i] = -1;
-      int maxCnt = 0;
-      ATTVAL maxVal = -1;
-      for (int i = 0; i < attSizes[nr_att - 1]; i++) {
-        att_array[nr_att - 1] = i;
-        int curCnt = countInstance(att_array, cur_ex, nr_cur_ex);
-        if (maxCnt < curCnt) {
-          maxCnt = curCnt;
-          maxVal = i;
-        }
-      }
+  // upper part by continued fraction ( modified Lentz )
+  double b = x + 1 - a;
+  double c = 1e300;
+  double d = 1 / b;
+  double h = d;
+  for (int i = 1; i < 1000; i++) {
+    double an = -i * (i - a);
+    b += 2;
+    d = an * d + b;
+    if (fabs(d) < 1e-300)
+      d = 1e-300;
+    c = b + an / c;
+    if (fabs(c) < 1e-300)
+      c = 1e-300;
+    d = 1 / d;
+    h *= d * c;
+    if (fabs(d * c - 1) < 1e-15)
+      break;
+  }
+  return front * h;
+}
 
-      if (!parent) { // Root node
-        if (tree) {
-          dtree->setRoot(new DTreeLeaf(maxVal));
-          print_tree_entry(indent, first, last, maxVal, true);
-        } else { // error
-          cout << "ERROR: Root node must have tree info" << endl;
-          exit(1);
-        }
-      } else { // leaf node
-        if (ch_index >= 0 && ch_index <= attSizes[parent->getAttIndex()]) {
-          parent->setOneChild(new DTreeLeaf(maxVal), ch_index);
-          print_tree_entry(indent, first, last, maxVal, true);
-        } else {
-          cout << "ERROR: ch_index is invalid" << endl;
-          exit(1);
-        }
-      }
-      return;
-    }
-  } 
-  else // cur_ex = NULL
-  {
-    // step 3. check if there is no example => make leaf as common val
-    if (nr_cur_ex <= 0) {
-      ATTVAL *att_array = new ATTVAL[nr_att];
-      for (int i = 0; i < nr_att - 1; i++)
-        att_array[i] = -1;
-      int maxCnt = 0;
-      ATTVAL maxVal = -1;
-      for (int i = 0; i < attSizes[nr_att - 1]; i++) {
-        att_array[nr_att - 1] = i;
-        int curCnt = countInstance(att_array, train, nr_train);
-        if (maxCnt < curCnt) {
-          maxCnt = curCnt;
-          maxVal = i;
-        }
-      }
+bool ID3::significant(DTreeRoot *node, int begin, int end) {
+  if (chiLevel <= 0)
+    return true;
+
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  ATTVAL nr_child = node->getNrChild();
+  ATTINDEX att = node->getAttIndex();
+
+  // ( child x class ) counts; child totals and class totals follow
+  double *cnt = new double[(nr_child + 1) * (nr_class + 1)];
+  for (int i = 0; i < (nr_child + 1) * (nr_class + 1); i++)
+    cnt[i] = 0;
+  double *class_cnt = cnt + nr_child * nr_class;
+  double *child_cnt = class_cnt + nr_class;
+  double sum = 0;
+  for (int i = begin; i < end; i++) {
+    int r = rowIndex[i];
+    double w = (weight) ? weight[r] : 1;
+    cnt[node->getBranch(train->getVal(r, att)) * nr_class +
+      train->getVal(r, nr_att - 1)] += w;
+    sum += w;
+  }
+  double scale = (sum > 0) ? (end - begin) / sum : 0;
+  for (ATTVAL v = 0; v < nr_child; v++) {
+    for (ATTVAL c = 0; c < nr_class; c++) {
+      cnt[v * nr_class + c] *= scale;
+      class_cnt[c] += cnt[v * nr_class + c];
+      child_cnt[v] += cnt[v * nr_class + c];
+    }
+  }
 
-      if (!parent) { // Root node
-        if (tree) {
-          dtree->setRoot(new DTreeLeaf(maxVal));
-          print_tree_entry(indent, first, last, maxVal, true);
-        } else { // error
-          cout << "ERROR: Root node must have tree info" << endl;
-          exit(1);
-        }
-      } else { // leaf node
-        if (ch_index >= 0 && ch_index <= attSizes[parent->getAttIndex()]) {
-          parent->setOneChild(new DTreeLeaf(maxVal), ch_index);
-          print_tree_entry(indent, first, last, maxVal, true);
-        } else {
-          cout << "ERROR: ch_index is invalid" << endl;
-          exit(1);
-        }
-      }
-      return;
-    } else {
-      cout << "ERROR: nr_cur_ex should be 0" << endl;
-      exit(1);
+  // empty children and classes add no degree of freedom
+  int nr_used_child = 0;
+  int nr_used_class = 0;
+  for (ATTVAL v = 0; v < nr_child; v++)
+    if (child_cnt[v] > 0)
+      nr_used_child++;
+  for (ATTVAL c = 0; c < nr_class; c++)
+    if (class_cnt[c] > 0)
+      nr_used_class++;
+  int df = (nr_used_child - 1) * (nr_used_class - 1);
+
+  double stat = 0;
+  double nr_ex = end - begin;
+  for (ATTVAL v = 0; v < nr_child; v++) {
+    for (ATTVAL c = 0; c < nr_class; c++) {
+      double expect = child_cnt[v] * class_cnt[c] / nr_ex;
+      if (expect > 0)
+        stat += (cnt[v * nr_class + c] - expect) * (cnt[v * nr_class + c] - expect) / expect;
     }
   }
+  delete [] cnt;
 
-  // step 4. making normal child node
-  ATTINDEX best = takeBestAtt(remainAtt, cur_ex, nr_cur_ex);
-  DTreeRoot *cur = 
-    new DTreeRoot(best, new DTreeNode*[attSizes[best]], attSizes[best]);
-  
+  return df > 0 && chiSquareTail(stat, df) < chiLevel;
+}
+
+DTreeNode* ID3::makeTestedNode(ATTVAL leaf_val, ATTINDEX &best, ATTVAL threshold,
+    int begin, int end) {
+  DTreeNode *cur = makeNode(leaf_val, best, threshold, begin, end);
+  if (best != -1 && !significant((DTreeRoot*) cur, begin, end)) { // pre-pruning
+    delete (cur);
+    best = -1;
+    cur = makeNode(leaf_val, best, threshold, begin, end);
+  }
+  return cur;
+}
+
+void ID3::attachNode(DTreeRoot *parent, int ch_index, DTree *tree, DTreeNode *cur) {
   if (!parent) { // Root node
     if (tree) {
       dtree->setRoot(cur);
-      print_tree_entry(indent, first, last, best, false);
     } else { // error
       cout << "ERROR: Root node must have tree info" << endl;
       exit(1);
     }
-  } else { // leaf node
-    if (ch_index >= 0 && ch_index <= attSizes[parent->getAttIndex()]) {
+  } else { // child node
+    if (ch_index >= 0 && ch_index < parent->getNrChild()) {
       parent->setOneChild(cur, ch_index);
-      print_tree_entry(indent, first, last, best, false);
     } else {
       cout << "ERROR: ch_index is invalid" << endl;
       exit(1);
     }
   }
+}
 
-  bool *new_remainAtt = new bool[nr_att - 1]; // make remainAtt copy
-  for (int i = 0; i < nr_att - 1; i++)
-    new_remainAtt[i] = remainAtt[i];
-  new_remainAtt[best] = false; // clear current 'best' attr
-  
-  for (int i = 0; i < attSizes[best]; i++) {
-    int nr_new_ex;
-    ATTVAL **new_ex = makeNewExam(cur_ex, nr_cur_ex, best, i, nr_new_ex);
-    recursive_make_tree(cur, i, NULL, new_remainAtt, new_ex, nr_new_ex, indent + 1, 
-    (i == 0) ? true : false, (i == attSizes[best] - 1) ? true : false);
+void ID3::recursive_make_tree(DTreeRoot *parent, int ch_index, DTree *tree, 
+    bool *remainAtt, int begin, int end, double *table, unsigned seed, int depth) {
+  // step 0. condition check
+  ASSERT (remainAtt != NULL, (char*) "remainAtt is NULL");
+  ASSERT (begin >= 0 && begin <= end, (char*) "row range is invalid");
+
+  // step 1 ~ 3. empty, pure, exhausted or deep enough node is leaf
+  ATTVAL leaf_val = leafValue(remainAtt, begin, end, depth);
+
+  // step 4. making normal child node ( or leaf if no attr can split )
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  ATTVAL threshold = 0;
+  ATTINDEX best = -1;
+  if (leaf_val < 0) {
+    if (!table) {
+      table = new double[tableSize + nr_class];
+      countTable(remainAtt, rowIndex + begin, end - begin, table, table + tableSize);
+    }
+    best = chooseAtt(remainAtt, begin, end, table, seed, threshold);
+  }
+  DTreeNode *cur = makeTestedNode(leaf_val, best, threshold, begin, end);
+  attachNode(parent, ch_index, tree, cur);
+  bool binary = (best != -1) && (attSizes[best] == 0 || binCol[best]);
+  ATTVAL nr_child = (best == -1) ? 0 : (binary) ? 2 : attSizes[best];
+
+  if (best == -1) {
+    if (table)
+      delete [] table;
+    return;
+  }
+
+  // step 5. partition rows in place; child ranges ( and the same ranges of
+  // rowScratch ) are disjoint, so children can be built concurrently
+  int *child_begin = new int[nr_child + 1];
+  partition(train, rowIndex, rowScratch, (DTreeRoot*) cur, begin, end, child_begin);
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) // presorted rows follow rowIndex
+    if (sortedRows[a])
+      partition(train, sortedRows[a], rowScratch, (DTreeRoot*) cur, begin, end,
+        child_begin);
+
+  // step 6. binary split keeps remainAtt, so the parent count table is still
+  // laid out for children; count the smaller child, and subtract it from the
+  // parent for the larger one ( only for unit weights, which subtract exactly )
+  double **child_table = new double*[nr_child];
+  for (int i = 0; i < nr_child; i++)
+    child_table[i] = NULL;
+  if (binary && !weight) {
+    int small = (child_begin[1] - child_begin[0] <= child_begin[2] - child_begin[1]) ? 0 : 1;
+    child_table[small] = new double[tableSize + nr_class];
+    countTable(remainAtt, rowIndex + child_begin[small],
+      child_begin[small + 1] - child_begin[small], child_table[small],
+      child_table[small] + tableSize);
+    for (int i = 0; i < tableSize + nr_class; i++)
+      table[i] -= child_table[small][i];
+    child_table[1 - small] = table;
+  } else {
+    delete [] table;
+  }
+
+  // random seeds of children are drawn in child order
+  unsigned *child_seed = new unsigned[nr_child];
+  for (int i = 0; i < nr_child; i++)
+    child_seed[i] = (nr_cand > 0) ? (unsigned) rand_r(&seed) : 0;
+
+  // clear current 'best' attr; continuous or binned attr can be tested again
+  bool used = !binary;
+  if (used)
+    remainAtt[best] = false;
+
+  // large children become tasks with their own copy of remainAtt
+  TaskGroup group;
+  BuildArg *args = new BuildArg[nr_child];
+  int nr_task = 0;
+  for (int i = 0; getPool()->getNrThread() > 1 && i < nr_child; i++) {
+    if (child_begin[i + 1] - child_begin[i] < SUBTREE_CUTOFF)
+      continue;
+    BuildArg *t = &args[nr_task++];
+    t->id3 = this;
+    t->parent = (DTreeRoot*) cur;
+    t->ch_index = i;
+    t->remainAtt = new bool[nr_att - 1];
+    for (int a = 0; a < nr_att - 1; a++)
+      t->remainAtt[a] = remainAtt[a];
+    t->begin = child_begin[i];
+    t->end = child_begin[i + 1];
+    t->table = child_table[i];
+    t->seed = child_seed[i];
+    t->depth = depth + 1;
+    getPool()->spawn(&group, buildTask, t);
   }
+
+  // small children are built inline while tasks run
+  for (int i = 0; i < nr_child; i++) {
+    if (getPool()->getNrThread() > 1 && child_begin[i + 1] - child_begin[i] >= SUBTREE_CUTOFF)
+      continue;
+    recursive_make_tree((DTreeRoot*) cur, i, NULL, remainAtt, child_begin[i],
+      child_begin[i + 1], child_table[i], child_seed[i], depth + 1);
+  }
+  getPool()->wait(&group);
+
+  for (int i = 0; i < nr_task; i++)
+    delete [] args[i].remainAtt;
+  delete [] args;
+  if (used)
+    remainAtt[best] = true; // restore for siblings of current node
+
+  delete [] child_seed;
+  delete [] child_table;
+  delete [] child_begin;
 }
 
-#define PRUNE_RATE 80 // the rate for accepting pruning
+#define LEVEL_TABLE_LIMIT (1 << 22) ///< count table entries of frontier counted at once
+
+/// @brief frontier node of level-wise building
+struct LevelNode {
+  DTreeRoot *parent;      ///< parent node which node hangs off ( NULL for root )
+  int       ch_index;     ///< child index in parent
+  bool      *remainAtt;   ///< remain attribute flags of node
+  int       begin;        ///< the first position of node range in rowIndex
+  int       end;          ///< the next position of the last one in range
+  unsigned  seed;         ///< random seed of node
+};
+
+/// @brief argument of one level count task; counts one column for frontier
+struct LevelCountArg {
+  ID3       *id3;         ///< ID3 engine
+  ATTINDEX  att;          ///< attribute index ( target attr counts classes )
+  int       *slot;        ///< count table slot of each position ( -1 if not counted )
+  int       begin;        ///< the first position swept
+  int       end;          ///< the next position of the last one swept
+  double    *tables;      ///< count tables of frontier, one per slot
+};
+
+/// @brief counting column of level rows into table of their node
+template <typename COL, typename VAL>
+static void count_level(const COL *col, const VAL *target, const int *rows,
+    const int *slot, int begin, int end, ATTVAL nr_class, int per_node,
+    int offset, const double *weight, double *tables) {
+  for (int i = begin; i < end; i++) {
+    if (slot[i] < 0)
+      continue;
+    int row = rows[i];
+    int val = (col) ? col[row] : 0;
+    tables[slot[i] * per_node + offset + val * nr_class + target[row]] +=
+      (weight) ? weight[row] : 1;
+  }
+}
 
-void ID3::recursive_prune_tree(DTreeNode *cur, ATTVAL *path, ATTVAL **valid, int nr_valid) {
-  ASSERT (cur != NULL && path != NULL);
-  for (int i = 0; i < nr_valid; i++)
-    ASSERT (valid[i] != NULL);
-  
-  if (valid) {
-    ATTVAL *new_path = new ATTVAL[nr_att]; // make path copy
-    for (int i = 0; i < nr_att - 1; i++)
-      new_path[i] = path[i];
-
-    // count from validation data itself
-    int maxCnt = 0;
-    ATTVAL maxVal = -1;
-    for (int i = 0; i < attSizes[nr_att - 1]; i++) {
-      new_path[nr_att - 1] = i;
-      int curCnt = countInstance(new_path, valid, nr_valid);
-      if (maxCnt < curCnt) {
-        maxCnt = curCnt;
-        maxVal = i;
+/// @brief count_level() on attr of data set, its bins or no column
+template <typename VAL>
+static void count_level_column(const DataSet *set, ATTINDEX att,
+    const ATTVAL *bin, const int *rows, const int *slot, int begin, int end,
+    ATTVAL nr_class, int per_node, int offset, const double *weight,
+    double *tables) {
+  const VAL *target = (const VAL*) set->getColumn(set->getNrAtt() - 1);
+  if (bin)
+    count_level(bin, target, rows, slot, begin, end, nr_class, per_node,
+      offset, weight, tables);
+  else
+    count_level((att < 0) ? (const VAL*) NULL : (const VAL*) set->getColumn(att),
+      target, rows, slot, begin, end, nr_class, per_node, offset, weight, tables);
+}
+
+void ID3::countLevel(ATTINDEX att, int *slot, int begin, int end, double *tables) {
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  int per_node = tableSize + nr_class;
+
+  // class counts follow the table; they are one column of a single value
+  ATTINDEX col = -1;
+  const ATTVAL *bin = NULL;
+  int offset = tableSize;
+  if (att < nr_att - 1) {
+    col = att;
+    bin = binCol[att];
+    offset = tableOffset[att];
+  }
+
+  if (train->getWidth() == sizeof(unsigned char))
+    count_level_column<unsigned char>(train, col, bin, rowIndex, slot, begin,
+      end, nr_class, per_node, offset, weight, tables);
+  else if (train->getWidth() == sizeof(unsigned short))
+    count_level_column<unsigned short>(train, col, bin, rowIndex, slot, begin,
+      end, nr_class, per_node, offset, weight, tables);
+  else
+    count_level_column<ATTVAL>(train, col, bin, rowIndex, slot, begin, end,
+      nr_class, per_node, offset, weight, tables);
+}
+
+void ID3::levelTask(void *arg) {
+  LevelCountArg *t = (LevelCountArg*) arg;
+  t->id3->countLevel(t->att, t->slot, t->begin, t->end, t->tables);
+}
+
+void ID3::level_make_tree(bool *remainAtt) {
+  int nr_train = (sample) ? nr_sample : train->getNrRow();
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  int per_node = tableSize + nr_class;
+  int chunk = LEVEL_TABLE_LIMIT / per_node;
+  if (chunk < 1)
+    chunk = 1;
+
+  int *slot = new int[nr_train];
+  for (int i = 0; i < nr_train; i++)
+    slot[i] = -1;
+
+  // frontier is kept in rowIndex order, since children ranges of a node
+  // follow each other and nodes are split in order
+  LevelNode *frontier = new LevelNode[1];
+  int nr_frontier = 1;
+  frontier[0].parent = NULL;
+  frontier[0].ch_index = 0;
+  frontier[0].remainAtt = new bool[nr_att - 1];
+  for (ATTINDEX a = 0; a < nr_att - 1; a++)
+    frontier[0].remainAtt[a] = remainAtt[a];
+  frontier[0].begin = 0;
+  frontier[0].end = nr_train;
+  frontier[0].seed = seed;
+
+  for (int depth = 0; nr_frontier > 0; depth++) {
+    // leaves need no count; the others are counted chunk by chunk
+    ATTVAL *leaf_val = new ATTVAL[nr_frontier];
+    int *open = new int[nr_frontier + 1];
+    int nr_open = 0;
+    int nr_next = 0;
+    for (int k = 0; k < nr_frontier; k++) {
+      LevelNode *f = &frontier[k];
+      leaf_val[k] = leafValue(f->remainAtt, f->begin, f->end, depth);
+      if (leaf_val[k] >= 0) {
+        attachNode(f->parent, f->ch_index, dtree,
+          makeNode(leaf_val[k], -1, 0, f->begin, f->end));
+        continue;
       }
+      open[nr_open++] = k;
+      ATTVAL most = 0;
+      for (ATTINDEX a = 0; a < nr_att - 1; a++)
+        if (f->remainAtt[a] && most < ((attSizes[a] == 0 || binCol[a]) ? 2 : attSizes[a]))
+          most = (attSizes[a] == 0 || binCol[a]) ? 2 : attSizes[a];
+      nr_next += most;
     }
-
-    // prune condition
-    if (100 * maxCnt / nr_valid > PRUNE_RATE) {
-      cur = new DTreeLeaf(maxVal);
-      return;
+    LevelNode *next = new LevelNode[nr_next + 1];
+    nr_next = 0;
+
+    for (int lo = 0; lo < nr_open; lo += chunk) {
+      int hi = (lo + chunk < nr_open) ? lo + chunk : nr_open;
+      int begin = frontier[open[lo]].begin;
+      int end = frontier[open[hi - 1]].end;
+      double *tables = new double[(hi - lo) * per_node];
+      for (int i = 0; i < (hi - lo) * per_node; i++)
+        tables[i] = 0;
+
+      // one sweep per column counts every open node of chunk
+      bool *need = new bool[nr_att];
+      for (ATTINDEX a = 0; a < nr_att; a++)
+        need[a] = (a == nr_att - 1);
+      for (int k = lo; k < hi; k++) {
+        LevelNode *f = &frontier[open[k]];
+        for (int i = f->begin; i < f->end; i++)
+          slot[i] = k - lo;
+        for (ATTINDEX a = 0; a < nr_att - 1; a++)
+          if (f->remainAtt[a] && !sortedRows[a])
+            need[a] = true;
+      }
+      int nr_col = 0;
+      for (ATTINDEX a = 0; a < nr_att; a++)
+        if (need[a])
+          nr_col++;
+      LevelCountArg *args = new LevelCountArg[nr_col];
+      TaskGroup group;
+      bool parallel = getPool()->getNrThread() > 1 && (long) (end - begin) * nr_col >= PARALLEL_CUTOFF;
+      for (ATTINDEX a = 0, k = 0; a < nr_att; a++) {
+        if (!need[a])
+          continue;
+        LevelCountArg *t = &args[k++];
+        t->id3 = this;
+        t->att = a;
+        t->slot = slot;
+        t->begin = begin;
+        t->end = end;
+        t->tables = tables;
+        if (parallel)
+          getPool()->spawn(&group, levelTask, t);
+        else
+          levelTask(t);
+      }
+      getPool()->wait(&group);
+      delete [] args;
+      delete [] need;
+
+      for (int k = lo; k < hi; k++) {
+        LevelNode *f = &frontier[open[k]];
+        for (int i = f->begin; i < f->end; i++)
+          slot[i] = -1;
+
+        // the same node as recursive_make_tree() makes, so trees don't
+        // depend on building order
+        ATTVAL threshold = 0;
+        ATTINDEX best = chooseAtt(f->remainAtt, f->begin, f->end,
+          tables + (k - lo) * per_node, f->seed, threshold);
+        DTreeNode *cur = makeTestedNode(leaf_val[open[k]], best, threshold,
+          f->begin, f->end);
+        attachNode(f->parent, f->ch_index, dtree, cur);
+        if (best == -1)
+          continue;
+
+        ATTVAL nr_child = ((DTreeRoot*) cur)->getNrChild();
+        int *child_begin = new int[nr_child + 1];
+        partition(train, rowIndex, rowScratch, (DTreeRoot*) cur, f->begin, f->end,
+          child_begin);
+        for (ATTINDEX a = 0; a < nr_att - 1; a++) // presorted rows follow rowIndex
+          if (sortedRows[a])
+            partition(train, sortedRows[a], rowScratch, (DTreeRoot*) cur, f->begin,
+              f->end, child_begin);
+
+        // random seeds of children are drawn in child order
+        bool used = attSizes[best] != 0 && !binCol[best];
+        for (int i = 0; i < nr_child; i++) {
+          LevelNode *c = &next[nr_next++];
+          c->parent = (DTreeRoot*) cur;
+          c->ch_index = i;
+          c->remainAtt = new bool[nr_att - 1];
+          for (ATTINDEX a = 0; a < nr_att - 1; a++)
+            c->remainAtt[a] = f->remainAtt[a];
+          if (used)
+            c->remainAtt[best] = false;
+          c->begin = child_begin[i];
+          c->end = child_begin[i + 1];
+          c->seed = (nr_cand > 0) ? (unsigned) rand_r(&f->seed) : 0;
+        }
+        delete [] child_begin;
+      }
+      delete [] tables;
     }
 
-    DTreeRoot *link = dynamic_cast <DTreeRoot*> (cur);
-    // if not, recursively search again
-    for (int i = 0; i < link->getNrChild(); i++) {
-      if (dynamic_cast <DTreeLeaf*> (link->getOneChild(i)))
-        continue;
+    for (int k = 0; k < nr_frontier; k++)
+      delete [] frontier[k].remainAtt;
+    delete [] frontier;
+    delete [] open;
+    delete [] leaf_val;
+    frontier = next;
+    nr_frontier = nr_next;
+  }
+  delete [] frontier;
+  delete [] slot;
+}
+
+/// @brief queued node of best-first building
+struct BestNode {
+  DTreeRoot *node;        ///< test node made for range ( not hung until expanded )
+  DTreeRoot *parent;      ///< parent node which node hangs off ( NULL for root )
+  int       ch_index;     ///< child index in parent
+  bool      *remainAtt;   ///< remain attribute flags of node
+  int       begin;        ///< the first position of node range in rowIndex
+  int       end;          ///< the next position of the last one in range
+  unsigned  seed;         ///< random seed of node ( advanced by choosing attr )
+  int       depth;        ///< depth of node
+  double    priority;     ///< Gain x rows ( weight sum if weighted )
+  int       order;        ///< queued order; the earlier wins a tie
+};
+
+/// @brief true if a is expanded before b
+static inline bool bestBefore(const BestNode &a, const BestNode &b) {
+  return a.priority > b.priority || (a.priority == b.priority && a.order < b.order);
+}
+
+/// @brief pushing into binary heap of queued nodes
+static void heapPush(BestNode *heap, int &nr_heap, const BestNode &b) {
+  int i = nr_heap++;
+  while (i > 0 && bestBefore(b, heap[(i - 1) / 2])) {
+    heap[i] = heap[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  heap[i] = b;
+}
+
+/// @brief popping the first node out of binary heap of queued nodes
+static BestNode heapPop(BestNode *heap, int &nr_heap) {
+  BestNode top = heap[0];
+  BestNode last = heap[--nr_heap];
+  int i = 0;
+  while (2 * i + 1 < nr_heap) {
+    int child = 2 * i + 1;
+    if (child + 1 < nr_heap && bestBefore(heap[child + 1], heap[child]))
+      child++;
+    if (!bestBefore(heap[child], last))
+      break;
+    heap[i] = heap[child];
+    i = child;
+  }
+  if (nr_heap > 0)
+    heap[i] = last;
+  return top;
+}
 
-      new_path[link->getAttIndex()] = i;
-      int nr_new_val;
-      ATTVAL **new_val = makeNewExam(valid, nr_valid, link->getAttIndex(), 
-          i, nr_new_val);
-      recursive_prune_tree(link->getOneChild(i), new_path, new_val, nr_new_val);
-      delete (new_val);
+/// @brief milliseconds since epoch
+static long nowMsec(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000L + tv.tv_usec / 1000;
+}
+
+bool ID3::openBest(BestNode *b) {
+  b->node = NULL;
+  ATTVAL leaf_val = leafValue(b->remainAtt, b->begin, b->end, b->depth);
+  ATTINDEX best = -1;
+  ATTVAL threshold = 0;
+  double gain = 0;
+  double nr_ex = 0;
+  if (leaf_val < 0) {
+    ATTVAL nr_class = attSizes[nr_att - 1];
+    double *table = new double[tableSize + nr_class];
+    countTable(b->remainAtt, rowIndex + b->begin, b->end - b->begin, table,
+      table + tableSize);
+    for (ATTVAL c = 0; c < nr_class; c++)
+      nr_ex += table[tableSize + c];
+    best = chooseAtt(b->remainAtt, b->begin, b->end, table, b->seed, threshold, &gain);
+    delete [] table;
+  }
+
+  DTreeNode *cur = makeTestedNode(leaf_val, best, threshold, b->begin, b->end);
+  if (best != -1) {
+    b->node = (DTreeRoot*) cur;
+    b->priority = gain * nr_ex;
+    cur = new DTreeLeaf(b->node->getMajor()); // stands in until expanded
+  }
+  attachNode(b->parent, b->ch_index, dtree, cur);
+
+  if (!b->node)
+    delete [] b->remainAtt;
+  return b->node != NULL;
+}
+
+void ID3::best_make_tree(bool *remainAtt) {
+  long start = nowMsec();
+  int nr_train = (sample) ? nr_sample : train->getNrRow();
+  int nr_node = 1;
+  int max_heap = 64;
+  int nr_heap = 0;
+  int nr_order = 0;
+  BestNode *heap = new BestNode[max_heap];
+
+  BestNode root;
+  root.parent = NULL;
+  root.ch_index = 0;
+  root.remainAtt = new bool[nr_att - 1];
+  for (ATTINDEX a = 0; a < nr_att - 1; a++)
+    root.remainAtt[a] = remainAtt[a];
+  root.begin = 0;
+  root.end = nr_train;
+  root.seed = seed;
+  root.depth = 0;
+  root.order = nr_order++;
+  if (openBest(&root))
+    heapPush(heap, nr_heap, root);
+
+  while (nr_heap > 0) {
+    if (timeBudget > 0 && nowMsec() - start >= timeBudget)
+      break; // out of time; the rest stay leaves
+    BestNode b = heapPop(heap, nr_heap);
+    DTreeRoot *cur = b.node;
+    ATTVAL nr_child = cur->getNrChild();
+    if (maxNodes > 0 && nr_node + nr_child > maxNodes) { // too big to fit
+      delete (cur);
+      delete [] b.remainAtt;
+      continue;
+    }
+    nr_node += nr_child;
+
+    // test node takes the place of its stand-in leaf
+    DTreeNode *leaf = (b.parent) ? b.parent->getOneChild(b.ch_index) : dtree->getRoot();
+    attachNode(b.parent, b.ch_index, dtree, cur);
+    delete (leaf);
+
+    int *child_begin = new int[nr_child + 1];
+    partition(train, rowIndex, rowScratch, cur, b.begin, b.end, child_begin);
+    for (ATTINDEX a = 0; a < nr_att - 1; a++) // presorted rows follow rowIndex
+      if (sortedRows[a])
+        partition(train, sortedRows[a], rowScratch, cur, b.begin, b.end, child_begin);
+
+    // random seeds of children are drawn in child order
+    ATTINDEX best = cur->getAttIndex();
+    bool used = attSizes[best] != 0 && !binCol[best];
+    for (int i = 0; i < nr_child; i++) {
+      BestNode c;
+      c.parent = cur;
+      c.ch_index = i;
+      c.remainAtt = new bool[nr_att - 1];
+      for (ATTINDEX a = 0; a < nr_att - 1; a++)
+        c.remainAtt[a] = b.remainAtt[a];
+      if (used)
+        c.remainAtt[best] = false;
+      c.begin = child_begin[i];
+      c.end = child_begin[i + 1];
+      c.seed = (nr_cand > 0) ? (unsigned) rand_r(&b.seed) : 0;
+      c.depth = b.depth + 1;
+      c.order = nr_order++;
+      if (!openBest(&c))
+        continue;
+      if (nr_heap == max_heap) {
+        BestNode *bigger = new BestNode[max_heap * 2];
+        for (int k = 0; k < nr_heap; k++)
+          bigger[k] = heap[k];
+        delete [] heap;
+        heap = bigger;
+        max_heap *= 2;
+      }
+      heapPush(heap, nr_heap, c);
     }
+    delete [] child_begin;
+    delete [] b.remainAtt;
+  }
+
+  // nodes left open keep their majority leaves
+  for (int k = 0; k < nr_heap; k++) {
+    delete (heap[k].node);
+    delete [] heap[k].remainAtt;
+  }
+  delete [] heap;
+}
 
-    delete (new_path);
+void ID3::recursive_print_tree(DTreeNode *cur, int indent, bool first, bool last) {
+  if (DTreeLeaf *leaf = dynamic_cast <DTreeLeaf*> (cur)) {
+    print_tree_entry(indent, first, last, leaf->getVal(), true);
+    return;
   }
+
+  DTreeRoot *link = dynamic_cast <DTreeRoot*> (cur);
+  ASSERT (link != NULL, (char*) "link is not valid");
+  int nr_first = 0;
+  for (ATTVAL v = 0; v < link->getNrGroup(); v++)
+    if (link->getGroup()[v] == 0)
+      nr_first++;
+  print_tree_entry(indent, first, last, link->getAttIndex(), false,
+    link->isNumeric(), link->getThreshold(), nr_first, link->getNrGroup());
+  for (int i = 0; i < link->getNrChild(); i++)
+    recursive_print_tree(link->getOneChild(i), indent + 1, (i == 0) ? true : false,
+      (i == link->getNrChild() - 1) ? true : false);
+}
+
+DTreeNode* ID3::recursive_prune_tree(DTreeNode *cur, int *rows, int *scratch,
+    int begin, int end, int &nr_error, int &nr_pruned) {
+  ASSERT (cur != NULL && rows != NULL && scratch != NULL && begin <= end);
+  if (DTreeLeaf *leaf = dynamic_cast <DTreeLeaf*> (cur)) {
+    nr_error = 0;
+    for (int i = begin; i < end; i++)
+      if (valid->getVal(rows[i], nr_att - 1) != leaf->getVal())
+        nr_error++;
+    return cur;
+  }
+
+  DTreeRoot *link = dynamic_cast <DTreeRoot*> (cur);
+  ASSERT (link != NULL, (char*) "link is not valid");
+
+  // errors if this node became its training majority leaf
+  int leaf_error = 0;
+  for (int i = begin; i < end; i++)
+    if (valid->getVal(rows[i], nr_att - 1) != link->getMajor())
+      leaf_error++;
+
+  // route rows to children, and prune children first ( bottom-up )
+  int *child_begin = new int[link->getNrChild() + 1];
+  partition(valid, rows, scratch, link, begin, end, child_begin);
+  int subtree_error = 0;
+  for (int i = 0; i < link->getNrChild(); i++) {
+    int child_error;
+    DTreeNode *child = recursive_prune_tree(link->getOneChild(i), rows, scratch,
+      child_begin[i], child_begin[i + 1], child_error, nr_pruned);
+    link->setOneChild(child, i);
+    subtree_error += child_error;
+  }
+  delete [] child_begin;
+
+  // prune if the leaf does no worse than the subtree on validation set
+  if (leaf_error <= subtree_error) {
+    DTreeNode *leaf = new DTreeLeaf(link->getMajor());
+    delete (link); // frees whole subtree
+    nr_pruned++;
+    nr_error = leaf_error;
+    return leaf;
+  }
+
+  nr_error = subtree_error;
+  return cur;
 }
 
@@ -0,0 +1,686 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file disk.cpp
+/// @brief Out-of-core Decision Tree Library Source File
+/// @details Level-wise ID3 making one pass over training file per depth.
+///
+/// @section reference_section Reference
+/// MACHINE LEARNING - TOM M. MITCHELL
+///
+/// @section purpose_section Purpose
+/// Application trial for personal studying
+///
+
+#include "disk.h"
+#include "assertion.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// DiskID3 class implementation
+///
+
+#define DISK_BUFFER       (1 << 20) ///< bytes read from file at once
+#define DISK_BINS         256       ///< default bins of continuous attr
+#define DISK_SAMPLE       (1 << 16) ///< rows sampled for bin edges
+#define DISK_SEED         12345     ///< random seed of row sample
+#define DISK_TABLE_LIMIT  (1 << 24) ///< count table entries held in one pass
+
+/// @brief node of tree being made
+struct DiskNode {
+  ATTINDEX  att;          ///< test attr ( -1 for leaf or frontier node )
+  ATTVAL    val;          ///< leaf value, or the most common target value of rows here
+  ATTVAL    thres;        ///< child 0 if value <= thres ( continuous attr test )
+  int       child;        ///< index of first child
+  ATTVAL    nr_child;     ///< the number of children
+  int       slot;         ///< count table slot in current pass ( -1 if not counted )
+  bool      *remain;      ///< remaining attr flags of frontier node ( NULL otherwise )
+};
+
+DiskID3::DiskID3(ATTVAL *attSizes, ATTINDEX nr_att, istream *file, int nr_row) {
+  ASSERT (attSizes != NULL && nr_att > 1 && file != NULL && nr_row > 0,
+    (char*) "DiskID3 condition error");
+  this->attSizes = attSizes;
+  this->nr_att = nr_att;
+  this->file = file;
+  this->nr_row = nr_row;
+  start = file->tellg();
+  trainStart = start;
+  nr_valid = nr_row / 4;
+  nr_bin = DISK_BINS;
+  maxDepth = 0;
+  minRows = 0;
+  nrBins = NULL;
+  binEdge = NULL;
+  tableOffset = NULL;
+  tableSize = 0;
+  node = NULL;
+  nr_node = 0;
+  max_node = 0;
+  trainMajor = -1;
+  nr_pass = 0;
+  cur_row = 0;
+  bad_row = -1;
+  buf = new char[DISK_BUFFER];
+  buf_pos = 0;
+  buf_len = 0;
+  buf_start = start;
+}
+
+DiskID3::~DiskID3() {
+  if (binEdge) {
+    for (ATTINDEX a = 0; a < nr_att - 1; a++)
+      if (binEdge[a])
+        delete [] binEdge[a];
+    delete [] binEdge;
+  }
+
+  if (nrBins)
+    delete [] nrBins;
+
+  if (tableOffset)
+    delete [] tableOffset;
+
+  if (node) {
+    for (int i = 0; i < nr_node; i++)
+      if (node[i].remain)
+        delete [] node[i].remain;
+    delete [] node;
+  }
+
+  delete [] buf;
+}
+
+DTree* DiskID3::takeTree() {
+  ASSERT (nr_node > 0 && attSizes != NULL, (char*) "tree is not made or taken");
+  DTree *tree = new DTree(build(0), attSizes, nr_att);
+  attSizes = NULL; // tree frees it
+  return tree;
+}
+
+int DiskID3::getNrPass() const {
+  return nr_pass;
+}
+
+int DiskID3::getBadRow() const {
+  return bad_row;
+}
+
+void DiskID3::setNrBin(int nr_bin) {
+  ASSERT (nr_bin == 0 || nr_bin >= 2, (char*) "histogram needs two bins at least");
+  this->nr_bin = (nr_bin > 0) ? nr_bin : DISK_BINS;
+}
+
+void DiskID3::setMaxDepth(int maxDepth) {
+  ASSERT (maxDepth >= 0, (char*) "max depth is negative");
+  this->maxDepth = maxDepth;
+}
+
+void DiskID3::setMinRows(int minRows) {
+  ASSERT (minRows >= 0, (char*) "minimum rows is negative");
+  this->minRows = minRows;
+}
+
+void DiskID3::rewind(streampos pos, int row) {
+  file->clear();
+  file->seekg(pos);
+  buf_start = pos;
+  buf_pos = 0;
+  buf_len = 0;
+  cur_row = row;
+  nr_pass++;
+}
+
+streampos DiskID3::tell() const {
+  return buf_start + (streamoff) buf_pos;
+}
+
+bool DiskID3::readRow(ATTVAL *row) {
+  for (ATTINDEX a = 0; a < nr_att; a++) {
+    // skip white space, refilling buffer as it runs out; a value is the
+    // run of other bytes up to the next white space
+    int len = 0;
+    bool good = true;
+    bool negative = false;
+    ATTVAL val = 0;
+    while (true) {
+      if (buf_pos == buf_len) {
+        buf_start += (streamoff) buf_len;
+        file->read(buf, DISK_BUFFER);
+        buf_len = (int) file->gcount();
+        buf_pos = 0;
+        if (buf_len == 0)
+          break;
+      }
+      char c = buf[buf_pos];
+      if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        if (len > 0)
+          break; // the end of value
+      } else {
+        if (c >= '0' && c <= '9')
+          val = val * 10 + (c - '0');
+        else if (c == '-' && len == 0)
+          negative = true;
+        else
+          good = false;
+        len++;
+      }
+      buf_pos++;
+    }
+    if (len == 0)
+      return false; // the end of file
+    if (negative)
+      val = -val;
+
+    // only continuous attr takes any integer
+    if (!good || (negative && len == 1) ||
+        (attSizes[a] > 0 && (val < 0 || val >= attSizes[a]))) {
+      if (bad_row < 0)
+        bad_row = cur_row;
+      return false;
+    }
+    row[a] = val;
+  }
+  cur_row++;
+  return true;
+}
+
+ATTVAL DiskID3::binOf(ATTINDEX att, ATTVAL val) const {
+  if (!binEdge[att])
+    return val;
+  // values beyond the last edge fall in the last bin
+  ATTVAL bin = lower_bound(binEdge[att], binEdge[att] + nrBins[att], val) - binEdge[att];
+  return (bin < nrBins[att]) ? bin : nrBins[att] - 1;
+}
+
+bool DiskID3::makeBins() {
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  ATTVAL *row = new ATTVAL[nr_att];
+
+  // validation rows are skipped once; later passes seek past them
+  rewind(start, 0);
+  for (int r = 0; r < nr_valid; r++)
+    if (!readRow(row))
+      break;
+  trainStart = tell();
+
+  int nr_cont = 0;
+  for (ATTINDEX a = 0; a < nr_att - 1; a++)
+    if (attSizes[a] == 0)
+      nr_cont++;
+
+  // reservoir sample of continuous values; every training row is equally likely
+  ATTVAL *sample = new ATTVAL[(nr_cont > 0) ? DISK_SAMPLE * nr_cont : 1];
+  int nr_sample = 0;
+  unsigned state = DISK_SEED;
+  for (int r = 0; nr_cont > 0 && bad_row < 0 && r < nr_row - nr_valid; r++) {
+    if (!readRow(row))
+      break;
+    int pos = r;
+    if (r >= DISK_SAMPLE) {
+      pos = rand_r(&state) % (r + 1);
+      if (pos >= DISK_SAMPLE)
+        continue;
+    } else {
+      nr_sample++;
+    }
+    for (ATTINDEX a = 0, k = 0; a < nr_att - 1; a++)
+      if (attSizes[a] == 0)
+        sample[(k++) * DISK_SAMPLE + pos] = row[a];
+  }
+
+  // a bin is closed at the first value change after bin_rows rows, as
+  // histogram mode of ID3 does, so ( value <= edge ) means a prefix of bins
+  int bin_rows = (nr_sample + nr_bin - 1) / nr_bin;
+  nrBins = new ATTVAL[nr_att - 1];
+  binEdge = new ATTVAL*[nr_att - 1];
+  for (ATTINDEX a = 0, k = 0; a < nr_att - 1; a++) {
+    nrBins[a] = 0;
+    binEdge[a] = NULL;
+    if (attSizes[a] != 0)
+      continue;
+
+    ATTVAL *sorted = sample + (k++) * DISK_SAMPLE;
+    sort(sorted, sorted + nr_sample);
+    binEdge[a] = new ATTVAL[(nr_bin < nr_sample) ? nr_bin : nr_sample + 1];
+    int nr_in = 0;
+    for (int i = 0; i < nr_sample; i++) {
+      nr_in++;
+      if (i == nr_sample - 1 || (nr_in >= bin_rows && sorted[i] != sorted[i + 1])) {
+        binEdge[a][nrBins[a]++] = sorted[i];
+        nr_in = 0;
+      }
+    }
+    if (nrBins[a] == 0) // no training row
+      binEdge[a][nrBins[a]++] = 0;
+  }
+  delete [] sample;
+  delete [] row;
+
+  // count table layout; continuous attr has one entry per bin
+  tableOffset = new int[nr_att];
+  tableSize = 0;
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+    tableOffset[a] = tableSize;
+    tableSize += ((binEdge[a]) ? nrBins[a] : attSizes[a]) * nr_class;
+  }
+  tableOffset[nr_att - 1] = tableSize;
+
+  return bad_row < 0;
+}
+
+int DiskID3::newNode() {
+  if (nr_node == max_node) {
+    max_node = (max_node > 0) ? max_node * 2 : 64;
+    DiskNode *grown = new DiskNode[max_node];
+    for (int i = 0; i < nr_node; i++)
+      grown[i] = node[i];
+    if (node)
+      delete [] node;
+    node = grown;
+  }
+
+  DiskNode *n = &node[nr_node];
+  n->att = -1;
+  n->val = -1;
+  n->thres = 0;
+  n->child = 0;
+  n->nr_child = 0;
+  n->slot = -1;
+  n->remain = NULL;
+  return nr_node++;
+}
+
+int DiskID3::route(const ATTVAL *row) const {
+  int i = 0;
+  while (node[i].att >= 0) {
+    int k = childOf(&node[i], row);
+    if (k < 0)
+      break; // no child takes the value
+    i = node[i].child + k;
+  }
+  return i;
+}
+
+int DiskID3::childOf(const DiskNode *n, const ATTVAL *row) const {
+  ATTVAL val = row[n->att];
+  if (attSizes[n->att] == 0)
+    return (val <= n->thres) ? 0 : 1;
+  return (val >= 0 && val < n->nr_child) ? val : -1;
+}
+
+/// @brief entropy of class counts ( same arithmetic as ID3 )
+///
+/// @param class_cnt class count array
+/// @param nr_class the number of classes
+/// @param nr_ex the number of examples
+/// @retval entropy
+static double entropy(const double *class_cnt, ATTVAL nr_class, double nr_ex) {
+  if (nr_ex <= 0)
+    return 0;
+  double e = 0;
+  for (ATTVAL c = 0; c < nr_class; c++) {
+    if (class_cnt[c] <= 0)
+      continue; // 0 * log(0) is regarded as 0
+    double p = class_cnt[c] / nr_ex;
+    e += -p * log(p) / log((double)2);
+  }
+  return e;
+}
+
+/// @brief the most common class ( the smallest one wins a tie )
+///
+/// @param class_cnt class count array
+/// @param nr_class the number of classes
+/// @retval the most common class ( -1 if no example )
+static ATTVAL major(const int *class_cnt, ATTVAL nr_class) {
+  int maxCnt = 0;
+  ATTVAL maxVal = -1;
+  for (ATTVAL c = 0; c < nr_class; c++) {
+    if (maxCnt < class_cnt[c]) {
+      maxCnt = class_cnt[c];
+      maxVal = c;
+    }
+  }
+  return maxVal;
+}
+
+bool DiskID3::makeChild(int index, int *class_cnt, bool *remain, int depth) {
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  int nr_ex = 0;
+  int nr_kind = 0;
+  for (ATTVAL c = 0; c < nr_class; c++) {
+    nr_ex += class_cnt[c];
+    if (class_cnt[c] > 0)
+      nr_kind++;
+  }
+  bool exhausted = true;
+  for (ATTINDEX a = 0; a < nr_att - 1; a++)
+    if (remain[a])
+      exhausted = false;
+
+  // leaf needs no pass: no row, one class, no attr left, deep enough or
+  // too few rows
+  node[index].val = (nr_ex == 0) ? trainMajor : major(class_cnt, nr_class);
+  if (nr_ex == 0 || nr_kind == 1 || exhausted || (maxDepth > 0 && depth >= maxDepth) ||
+      nr_ex < minRows) {
+    delete [] remain;
+    return false;
+  }
+  node[index].remain = remain;
+  return true;
+}
+
+void DiskID3::split(int index, int *table, int *next, int &nr_next, int depth) {
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  int *class_cnt = table + tableSize;
+  bool *remain = node[index].remain;
+  node[index].remain = NULL;
+  node[index].val = major(class_cnt, nr_class);
+
+  double *cnt = new double[nr_class];
+  double *left = new double[nr_class];
+  double *right = new double[nr_class];
+  double nr_ex = 0;
+  for (ATTVAL c = 0; c < nr_class; c++) {
+    cnt[c] = class_cnt[c];
+    nr_ex += cnt[c];
+  }
+  double total = entropy(cnt, nr_class, nr_ex);
+
+  // gains are taken in attribute order, so the lowest index wins a tie
+  ATTINDEX best = -1;
+  double max_gain = 0;
+  ATTVAL best_cut = 0;
+  for (ATTINDEX a = 0; nr_ex > 0 && a < nr_att - 1; a++) {
+    if (!remain[a])
+      continue;
+    int *att_table = table + tableOffset[a];
+
+    if (!binEdge[a]) { // multiway split on every value
+      double gain = total;
+      for (ATTVAL v = 0; v < attSizes[a]; v++) {
+        double nr_val = 0;
+        for (ATTVAL c = 0; c < nr_class; c++) {
+          left[c] = att_table[v * nr_class + c];
+          nr_val += left[c];
+        }
+        gain -= (nr_val / nr_ex) * entropy(left, nr_class, nr_val);
+      }
+      if (best == -1 || gain > max_gain) {
+        max_gain = gain;
+        best = a;
+      }
+      continue;
+    }
+
+    // binary split after a prefix of bins; the last bin having rows ends it
+    ATTVAL last = -1;
+    for (ATTVAL b = 0; b < nrBins[a]; b++)
+      for (ATTVAL c = 0; c < nr_class; c++)
+        if (att_table[b * nr_class + c] > 0)
+          last = b;
+    for (ATTVAL c = 0; c < nr_class; c++) {
+      left[c] = 0;
+      right[c] = cnt[c];
+    }
+    double nr_left = 0;
+    for (ATTVAL b = 0; b < last; b++) {
+      for (ATTVAL c = 0; c < nr_class; c++) {
+        left[c] += att_table[b * nr_class + c];
+        right[c] -= att_table[b * nr_class + c];
+        nr_left += att_table[b * nr_class + c];
+      }
+      if (nr_left <= 0)
+        continue; // left side is empty
+      double nr_right = nr_ex - nr_left;
+      double gain = total -
+        (nr_left / nr_ex) * entropy(left, nr_class, nr_left) -
+        (nr_right / nr_ex) * entropy(right, nr_class, nr_right);
+      if (best == -1 || gain > max_gain) {
+        max_gain = gain;
+        best = a;
+        best_cut = b;
+      }
+    }
+  }
+  delete [] cnt;
+  delete [] left;
+  delete [] right;
+
+  if (best == -1) { // no attr can split rows
+    delete [] remain;
+    return;
+  }
+
+  // children are appended adjacently; node array may move, so use indices
+  bool binned = binEdge[best] != NULL;
+  ATTVAL nr_child = (binned) ? 2 : attSizes[best];
+  int first = nr_node;
+  for (ATTVAL i = 0; i < nr_child; i++)
+    newNode();
+  node[index].att = best;
+  node[index].thres = (binned) ? binEdge[best][best_cut] : 0;
+  node[index].child = first;
+  node[index].nr_child = nr_child;
+
+  int *att_table = table + tableOffset[best];
+  int *child_cnt = new int[nr_class];
+  for (ATTVAL i = 0; i < nr_child; i++) {
+    for (ATTVAL c = 0; c < nr_class; c++)
+      child_cnt[c] = (binned) ? 0 : att_table[i * nr_class + c];
+    for (ATTVAL b = 0; binned && b < nrBins[best]; b++)
+      if ((b <= best_cut) == (i == 0))
+        for (ATTVAL c = 0; c < nr_class; c++)
+          child_cnt[c] += att_table[b * nr_class + c];
+
+    // continuous attr can be tested again below
+    bool *child_remain = new bool[nr_att - 1];
+    for (ATTINDEX a = 0; a < nr_att - 1; a++)
+      child_remain[a] = remain[a];
+    if (!binned)
+      child_remain[best] = false;
+    if (makeChild(first + i, child_cnt, child_remain, depth + 1))
+      next[nr_next++] = first + i;
+  }
+  delete [] child_cnt;
+  delete [] remain;
+}
+
+bool DiskID3::makeTree() {
+  ASSERT (nr_row - nr_valid > 0 && nr_node == 0, (char*) "makeTree condition error");
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  int nr_train = nr_row - nr_valid;
+
+  if (!makeBins())
+    return false;
+
+  // root is the first frontier; others join when their parent splits
+  int root = newNode();
+  node[root].remain = new bool[nr_att - 1];
+  for (ATTINDEX a = 0; a < nr_att - 1; a++)
+    node[root].remain[a] = true;
+  int nr_frontier = 1;
+  int *frontier = new int[1];
+  frontier[0] = root;
+
+  // a frontier can't be larger than the number of training rows, and each
+  // node of it has at most nr_child children joining the next one
+  ATTVAL *row = new ATTVAL[nr_att];
+  int per_node = tableSize + nr_class;
+  int chunk = DISK_TABLE_LIMIT / per_node;
+  if (chunk < 1)
+    chunk = 1;
+  int depth = 0;
+  for (; nr_frontier > 0; depth++) {
+    int max_next = 0;
+    int *next = NULL;
+    int nr_next = 0;
+
+    for (int lo = 0; lo < nr_frontier; lo += chunk) {
+      int hi = (lo + chunk < nr_frontier) ? lo + chunk : nr_frontier;
+      int *table = new int[(hi - lo) * per_node];
+      for (int i = 0; i < (hi - lo) * per_node; i++)
+        table[i] = 0;
+      for (int k = lo; k < hi; k++)
+        node[frontier[k]].slot = k - lo;
+
+      // one pass counts rows reaching this chunk of frontier
+      rewind(trainStart, nr_valid);
+      for (int r = 0; r < nr_train; r++) {
+        if (!readRow(row))
+          break;
+        DiskNode *n = &node[route(row)];
+        if (n->slot < 0)
+          continue;
+        int *cnt = table + n->slot * per_node;
+        ATTVAL c = row[nr_att - 1];
+        for (ATTINDEX a = 0; a < nr_att - 1; a++)
+          if (n->remain[a])
+            cnt[tableOffset[a] + binOf(a, row[a]) * nr_class + c]++;
+        cnt[tableSize + c]++;
+      }
+      if (bad_row >= 0) {
+        delete [] table;
+        break;
+      }
+      if (depth == 0)
+        trainMajor = major(table + tableSize, nr_class);
+
+      for (int k = lo; k < hi; k++) {
+        int f = frontier[k];
+        node[f].slot = -1;
+        int nr_ex = 0;
+        int nr_kind = 0;
+        for (ATTVAL c = 0; c < nr_class; c++) {
+          nr_ex += table[(k - lo) * per_node + tableSize + c];
+          if (table[(k - lo) * per_node + tableSize + c] > 0)
+            nr_kind++;
+        }
+        // root is checked here; other frontier nodes were checked by parent
+        if (nr_kind <= 1) {
+          node[f].val = (nr_ex > 0) ? major(table + (k - lo) * per_node + tableSize,
+            nr_class) : trainMajor;
+          delete [] node[f].remain;
+          node[f].remain = NULL;
+          continue;
+        }
+        ATTVAL most = 0;
+        for (ATTINDEX a = 0; a < nr_att - 1; a++)
+          if (node[f].remain[a])
+            most = max(most, (binEdge[a]) ? (ATTVAL) 2 : attSizes[a]);
+        if (nr_next + most > max_next) {
+          max_next = (nr_next + most) * 2;
+          int *grown = new int[max_next];
+          for (int i = 0; i < nr_next; i++)
+            grown[i] = next[i];
+          if (next)
+            delete [] next;
+          next = grown;
+        }
+        split(f, table + (k - lo) * per_node, next, nr_next, depth);
+      }
+      delete [] table;
+    }
+
+    delete [] frontier;
+    frontier = next;
+    nr_frontier = (bad_row < 0) ? nr_next : 0;
+  }
+  if (frontier)
+    delete [] frontier;
+  delete [] row;
+  if (bad_row >= 0)
+    return false;
+
+  cout << "///      " << depth << " levels in " << nr_pass << " passes over "
+    << nr_train << " rows ( " << countNode(root) << " nodes )" << endl;
+  return true;
+}
+
+void DiskID3::prune() {
+  ASSERT (nr_node > 0 && attSizes != NULL, (char*) "tree is not made or taken");
+  if (nr_valid == 0 || node[0].att < 0)
+    return;
+
+  // validation rows reaching each node, and those its majority gets right
+  int *reach = new int[nr_node];
+  int *right = new int[nr_node];
+  for (int i = 0; i < nr_node; i++) {
+    reach[i] = 0;
+    right[i] = 0;
+  }
+  ATTVAL *row = new ATTVAL[nr_att];
+  int nr_read = 0;
+  rewind(start, 0);
+  for (; nr_read < nr_valid; nr_read++) {
+    if (!readRow(row))
+      break;
+    int i = 0;
+    while (true) {
+      reach[i]++;
+      if (row[nr_att - 1] == node[i].val)
+        right[i]++;
+      if (node[i].att < 0)
+        break;
+      int k = childOf(&node[i], row);
+      if (k < 0)
+        break;
+      i = node[i].child + k;
+    }
+  }
+  delete [] row;
+
+  // children always come after their parent, so a backward sweep is bottom-up
+  int *error = new int[nr_node];
+  int nr_before = countNode(0);
+  int nr_pruned = 0;
+  for (int i = nr_node - 1; i >= 0; i--) {
+    error[i] = reach[i] - right[i];
+    if (node[i].att < 0)
+      continue;
+    int subtree_error = 0;
+    for (int k = 0; k < node[i].nr_child; k++)
+      subtree_error += error[node[i].child + k];
+    if (error[i] <= subtree_error) {
+      node[i].att = -1; // children become unreachable
+      nr_pruned++;
+    } else {
+      error[i] = subtree_error;
+    }
+  }
+
+  cout << "///      " << nr_pruned << " subtrees are pruned ( " << nr_before
+    << " -> " << countNode(0) << " nodes, " << error[0] << " / "
+    << nr_read << " validation errors )" << endl;
+  delete [] error;
+  delete [] reach;
+  delete [] right;
+}
+
+DTreeNode* DiskID3::build(int index) const {
+  const DiskNode *n = &node[index];
+  if (n->att < 0)
+    return new DTreeLeaf(n->val);
+
+  DTreeRoot *link = new DTreeRoot(n->att, new DTreeNode*[n->nr_child], n->nr_child);
+  link->setMajor(n->val);
+  if (attSizes[n->att] == 0)
+    link->setThreshold(n->thres);
+  for (ATTVAL i = 0; i < n->nr_child; i++)
+    link->setOneChild(build(n->child + i), i);
+  return link;
+}
+
+int DiskID3::countNode(int index) const {
+  int nr = 1;
+  if (node[index].att >= 0)
+    for (ATTVAL i = 0; i < node[index].nr_child; i++)
+      nr += countNode(node[index].child + i);
+  return nr;
+}
@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file ensemble.cpp
+/// @brief Tree Ensemble Library Source File
+/// @details Weighted vote of ID3 member trees.
+///
+/// @section purpose_section Purpose
+/// Application trial for personal studying
+///
+
+#include "ensemble.h"
+#include "assertion.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Ensemble class implementation
+///
+
+#define ENSEMBLE_BLOCK  (1 << 10) ///< rows per prediction task
+
+Ensemble::Ensemble(ATTVAL *attSizes, ATTINDEX nr_att) {
+  ASSERT (attSizes != NULL && nr_att > 1, (char*) "Ensemble condition error");
+  this->attSizes = attSizes;
+  this->nr_att = nr_att;
+  trees = NULL;
+  alpha = NULL;
+  nr_member = 0;
+  nr_thread = 0;
+  pool = NULL;
+}
+
+Ensemble::~Ensemble() {
+  if (trees) {
+    for (int t = 0; t < nr_member; t++)
+      if (trees[t])
+        delete (trees[t]);
+    delete [] trees;
+  }
+
+  if (alpha)
+    delete [] alpha;
+
+  if (pool)
+    delete (pool);
+}
+
+void Ensemble::setNrThread(int nr_thread) {
+  this->nr_thread = nr_thread;
+  if (pool) { // started again with the new count on next use
+    delete (pool);
+    pool = NULL;
+  }
+}
+
+WorkPool* Ensemble::getPool() {
+  // threads start on first parallel use, so setNrThread() never wastes them
+  if (!pool)
+    pool = new WorkPool(nr_thread);
+  return pool;
+}
+
+void Ensemble::gather(const DataSet *data, int begin, int n, ATTVAL *rows) const {
+  int stride = nr_att - 1;
+  for (ATTINDEX a = 0; a < stride; a++)
+    for (int r = 0; r < n; r++)
+      rows[r * stride + a] = data->getVal(begin + r, a);
+}
+
+ATTVAL Ensemble::predict(ATTVAL *input) {
+  ASSERT (trees != NULL, (char*) "ensemble is not made");
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  double *cnt = new double[nr_class];
+  for (ATTVAL c = 0; c < nr_class; c++)
+    cnt[c] = 0;
+  for (int t = 0; t < nr_member; t++) {
+    ATTVAL val = trees[t]->predict(input);
+    if (val >= 0)
+      cnt[val] += (alpha) ? alpha[t] : 1;
+  }
+
+  ATTVAL best = vote(cnt, nr_class);
+  delete [] cnt;
+
+  return best;
+}
+
+void Ensemble::predictBlock(const ATTVAL *rows, size_t n, ATTVAL *out) {
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  double *cnt = new double[n * nr_class];
+  ATTVAL *val = new ATTVAL[n];
+  for (size_t i = 0; i < n * nr_class; i++)
+    cnt[i] = 0;
+
+  // one tree over the whole block at a time keeps the tree in cache
+  for (int t = 0; t < nr_member; t++) {
+    double weight = (alpha) ? alpha[t] : 1;
+    trees[t]->predictBatch(rows, n, val);
+    for (size_t r = 0; r < n; r++)
+      if (val[r] >= 0)
+        cnt[r * nr_class + val[r]] += weight;
+  }
+
+  for (size_t r = 0; r < n; r++)
+    out[r] = vote(cnt + r * nr_class, nr_class);
+
+  delete [] cnt;
+  delete [] val;
+}
+
+/// @brief argument of one prediction task; votes one row block
+struct EnsemblePredictArg {
+  Ensemble      *ensemble;  ///< tree ensemble
+  const ATTVAL  *rows;      ///< row block
+  size_t        n;          ///< the number of rows in block
+  ATTVAL        *out;       ///< prediction values of block
+};
+
+void Ensemble::predictTask(void *arg) {
+  EnsemblePredictArg *t = (EnsemblePredictArg*) arg;
+  t->ensemble->predictBlock(t->rows, t->n, t->out);
+}
+
+void Ensemble::predictBatch(const ATTVAL *rows, size_t n, ATTVAL *out) {
+  ASSERT (rows != NULL && out != NULL && trees != NULL,
+    (char*) "predictBatch condition error");
+  int stride = nr_att - 1;
+
+  size_t nr_block = (n + ENSEMBLE_BLOCK - 1) / ENSEMBLE_BLOCK;
+  EnsemblePredictArg *args = new EnsemblePredictArg[nr_block];
+  TaskGroup group;
+  for (size_t b = 0; b < nr_block; b++) {
+    EnsemblePredictArg *t = &args[b];
+    t->ensemble = this;
+    t->rows = rows + b * ENSEMBLE_BLOCK * stride;
+    t->n = (b == nr_block - 1) ? n - b * ENSEMBLE_BLOCK : ENSEMBLE_BLOCK;
+    t->out = out + b * ENSEMBLE_BLOCK;
+    getPool()->spawn(&group, predictTask, t);
+  }
+  getPool()->wait(&group);
+  delete [] args;
+}
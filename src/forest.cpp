@@ -0,0 +1,188 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file forest.cpp
+/// @brief Random Forest Library Source File
+/// @details Bagged ensemble of ID3 trees.
+///
+/// @section reference_section Reference
+/// RANDOM FORESTS - LEO BREIMAN
+///
+/// @section purpose_section Purpose
+/// Application trial for personal studying
+///
+
+#include "forest.h"
+#include "assertion.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Forest class implementation
+///
+
+#define FOREST_SEED   12345     ///< random seed of forest
+#define FOREST_BLOCK  (1 << 10) ///< rows per out-of-bag prediction block
+
+Forest::Forest(ATTVAL *attSizes, ATTINDEX nr_att, DataSet *data, int nr_tree)
+  : Ensemble(attSizes, nr_att) {
+  ASSERT (data != NULL && data->getNrRow() > 0 && nr_tree > 0,
+          (char*) "Forest condition error");
+  this->data = data;
+  this->nr_tree = nr_tree;
+  nr_bin = 0;
+  level = false;
+  maxDepth = 0;
+  chiLevel = 0;
+  minRows = 0;
+  seed = FOREST_SEED;
+  votes = NULL;
+  nr_oob = 0;
+  nr_oob_error = 0;
+}
+
+Forest::~Forest() {
+  if (data)
+    delete (data);
+}
+
+int Forest::getNrTree() const {
+  return nr_tree;
+}
+
+double Forest::getOOBError() const {
+  return (nr_oob > 0) ? (double) nr_oob_error / (double) nr_oob : 0;
+}
+
+void Forest::setLevelWise(bool level) {
+  this->level = level;
+}
+
+void Forest::setMaxDepth(int maxDepth) {
+  ASSERT (maxDepth >= 0, (char*) "max depth is negative");
+  this->maxDepth = maxDepth;
+}
+
+void Forest::setSignificance(double chiLevel) {
+  ASSERT (chiLevel >= 0 && chiLevel < 1, (char*) "significance level is out of range");
+  this->chiLevel = chiLevel;
+}
+
+void Forest::setMinRows(int minRows) {
+  ASSERT (minRows >= 0, (char*) "minimum rows is negative");
+  this->minRows = minRows;
+}
+
+void Forest::setNrBin(int nr_bin) {
+  ASSERT (nr_bin == 0 || nr_bin >= 2, (char*) "histogram needs two bins at least");
+  this->nr_bin = nr_bin;
+}
+
+/// @brief argument of one tree task; builds one member tree
+struct TreeArg {
+  Forest    *forest;      ///< forest which tree belongs to
+  int       index;        ///< tree index
+  unsigned  seed;         ///< random seed of tree
+};
+
+void Forest::treeTask(void *arg) {
+  TreeArg *t = (TreeArg*) arg;
+  t->forest->makeOneTree(t->index, t->seed);
+}
+
+void Forest::makeOneTree(int index, unsigned seed) {
+  int nr_row = data->getNrRow();
+  ATTVAL nr_class = attSizes[nr_att - 1];
+
+  // bootstrap sample; n rows drawn with replacement
+  int *sample = new int[nr_row];
+  bool *inbag = new bool[nr_row];
+  for (int i = 0; i < nr_row; i++)
+    inbag[i] = false;
+  for (int i = 0; i < nr_row; i++) {
+    sample[i] = rand_r(&seed) % nr_row;
+    inbag[sample[i]] = true;
+  }
+
+  // about sqrt of attrs are drawn at each node
+  int nr_cand = (int) sqrt((double) (nr_att - 1));
+  if (nr_cand < 1)
+    nr_cand = 1;
+
+  ID3 *tree = new ID3(attSizes, nr_att, data, getPool());
+  tree->setSample(sample, nr_row);
+  tree->setNrCand(nr_cand, (unsigned) rand_r(&seed));
+  tree->setNrBin(nr_bin);
+  tree->setLevelWise(level);
+  tree->setMaxDepth(maxDepth);
+  tree->setSignificance(chiLevel);
+  tree->setMinRows(minRows);
+  tree->makeTree();
+  trees[index] = tree;
+
+  // vote for rows this tree has never seen
+  ATTVAL *rows = new ATTVAL[FOREST_BLOCK * (nr_att - 1)];
+  ATTVAL *val = new ATTVAL[FOREST_BLOCK];
+  for (int begin = 0; begin < nr_row; begin += FOREST_BLOCK) {
+    int n = (nr_row - begin < FOREST_BLOCK) ? nr_row - begin : FOREST_BLOCK;
+    gather(data, begin, n, rows);
+    tree->predictBatch(rows, n, val);
+    for (int r = 0; r < n; r++)
+      if (!inbag[begin + r] && val[r] >= 0)
+        __sync_fetch_and_add(&votes[(begin + r) * nr_class + val[r]], 1);
+  }
+
+  delete [] val;
+  delete [] rows;
+  delete [] inbag;
+  delete [] sample;
+}
+
+void Forest::makeForest() {
+  int nr_row = data->getNrRow();
+  ATTVAL nr_class = attSizes[nr_att - 1];
+
+  votes = new int[nr_row * nr_class];
+  for (int i = 0; i < nr_row * nr_class; i++)
+    votes[i] = 0;
+
+  // seeds are drawn in tree order, so trees don't depend on scheduling
+  trees = new ID3*[nr_tree];
+  nr_member = nr_tree;
+  TreeArg *args = new TreeArg[nr_tree];
+  unsigned state = seed;
+  for (int t = 0; t < nr_tree; t++) {
+    trees[t] = NULL;
+    args[t].forest = this;
+    args[t].index = t;
+    args[t].seed = (unsigned) rand_r(&state);
+  }
+  TaskGroup group;
+  for (int t = 0; t < nr_tree; t++)
+    getPool()->spawn(&group, treeTask, &args[t]);
+  getPool()->wait(&group);
+  delete [] args;
+
+  // out-of-bag error; majority of votes from trees not trained on the row
+  nr_oob = 0;
+  nr_oob_error = 0;
+  for (int r = 0; r < nr_row; r++) {
+    ATTVAL best = vote(votes + r * nr_class, nr_class);
+    if (best == -1)
+      continue; // in every bootstrap sample
+    nr_oob++;
+    if (best != data->getVal(r, nr_att - 1))
+      nr_oob_error++;
+  }
+  delete [] votes;
+  votes = NULL;
+
+  int nr_node = 0;
+  for (int t = 0; t < nr_tree; t++)
+    nr_node += trees[t]->getNrNode();
+  cout << "///      " << nr_tree << " trees ( " << nr_node << " nodes ), "
+    << nr_oob_error << " / " << nr_oob << " out-of-bag errors" << endl;
+}
@@ -0,0 +1,281 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file hoeffding.cpp
+/// @brief Hoeffding Tree Library Source File
+/// @details VFDT splitting leaves by Hoeffding bound.
+///
+/// @section reference_section Reference
+/// MINING HIGH-SPEED DATA STREAMS - PEDRO DOMINGOS, GEOFF HULTEN
+///
+/// @section purpose_section Purpose
+/// Application trial for personal studying
+///
+
+#include "hoeffding.h"
+#include "assertion.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Hoeffding class implementation
+///
+
+#define HOEFF_NODES   1024  ///< initial capacity of node array
+#define HOEFF_DELTA   1e-7  ///< default probability of a wrong split
+#define HOEFF_GRACE   200   ///< default rows between split checks
+#define HOEFF_TIE     0.05  ///< bound under which close attrs are taken as a tie
+
+/// @brief node of Hoeffding tree
+struct HoeffNode {
+  ATTINDEX  att;          ///< test attr ( -1 for leaf )
+  int       child;        ///< index of first child; the others follow it
+  ATTVAL    val;          ///< leaf value while leaf has no row, majority at split for test node
+  int       depth;        ///< depth of node ( root is 0 )
+  long      *count;       ///< count table of leaf ( class counts follow, NULL for test node )
+  bool      *remain;      ///< remaining attr flags of leaf ( NULL for test node )
+  int       nr_new;       ///< rows since the last split check
+};
+
+/// @brief entropy of class counts as ID3::calEntropy() takes it
+static double entropy(const long *class_cnt, ATTVAL nr_class, double nr_ex) {
+  if (nr_ex <= 0)
+    return 0;
+  double e = 0;
+  for (ATTVAL c = 0; c < nr_class; c++) {
+    if (class_cnt[c] <= 0)
+      continue;
+    double p = ((double) class_cnt[c]) / nr_ex;
+    e += -p * log(p) / log((double) 2);
+  }
+  return e;
+}
+
+/// @brief the most common class; the smallest value wins a tie
+static ATTVAL major(const long *class_cnt, ATTVAL nr_class) {
+  long most = 0;
+  ATTVAL val = -1;
+  for (ATTVAL c = 0; c < nr_class; c++) {
+    if (most < class_cnt[c]) {
+      most = class_cnt[c];
+      val = c;
+    }
+  }
+  return val;
+}
+
+Hoeffding::Hoeffding(ATTVAL *attSizes, ATTINDEX nr_att) {
+  ASSERT (attSizes != NULL && nr_att > 1 && attSizes[nr_att - 1] > 0,
+    (char*) "Hoeffding condition error");
+  for (ATTINDEX a = 0; a < nr_att - 1; a++)
+    ASSERT (attSizes[a] > 0, (char*) "Hoeffding tree needs nominal attributes");
+  this->attSizes = attSizes;
+  this->nr_att = nr_att;
+
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  tableOffset = new int[nr_att - 1];
+  tableSize = 0;
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+    tableOffset[a] = tableSize;
+    tableSize += attSizes[a] * nr_class;
+  }
+
+  delta = HOEFF_DELTA;
+  grace = HOEFF_GRACE;
+  maxDepth = 0;
+  nr_row = 0;
+  nr_split = 0;
+  max_node = HOEFF_NODES;
+  nr_node = 0;
+  node = new HoeffNode[max_node];
+
+  bool *remain = new bool[nr_att - 1];
+  for (ATTINDEX a = 0; a < nr_att - 1; a++)
+    remain[a] = true;
+  newLeaf(0, 0, remain);
+}
+
+Hoeffding::~Hoeffding() {
+  for (int i = 0; i < nr_node; i++) {
+    if (node[i].count)
+      delete [] node[i].count;
+    if (node[i].remain)
+      delete [] node[i].remain;
+  }
+  delete [] node;
+  delete [] tableOffset;
+}
+
+DTree* Hoeffding::makeDTree() const {
+  ATTVAL *sizes = new ATTVAL[nr_att]; // tree frees it
+  for (ATTINDEX a = 0; a < nr_att; a++)
+    sizes[a] = attSizes[a];
+  return new DTree(build(0), sizes, nr_att);
+}
+
+long Hoeffding::getNrRow() const {
+  return nr_row;
+}
+
+int Hoeffding::getNrNode() const {
+  return nr_node;
+}
+
+int Hoeffding::getNrSplit() const {
+  return nr_split;
+}
+
+void Hoeffding::setConfidence(double delta) {
+  ASSERT (delta >= 0 && delta < 1, (char*) "confidence delta is out of range");
+  this->delta = (delta > 0) ? delta : HOEFF_DELTA;
+}
+
+void Hoeffding::setGrace(int grace) {
+  ASSERT (grace >= 0, (char*) "grace period is negative");
+  this->grace = (grace > 0) ? grace : HOEFF_GRACE;
+}
+
+void Hoeffding::setMaxDepth(int maxDepth) {
+  ASSERT (maxDepth >= 0, (char*) "max depth is negative");
+  this->maxDepth = maxDepth;
+}
+
+int Hoeffding::newLeaf(int depth, ATTVAL val, bool *remain) {
+  if (nr_node == max_node) {
+    HoeffNode *bigger = new HoeffNode[max_node * 2];
+    for (int i = 0; i < nr_node; i++)
+      bigger[i] = node[i];
+    delete [] node;
+    node = bigger;
+    max_node *= 2;
+  }
+  HoeffNode *n = &node[nr_node];
+  n->att = -1;
+  n->child = -1;
+  n->val = val;
+  n->depth = depth;
+  n->count = new long[tableSize + attSizes[nr_att - 1]];
+  for (int i = 0; i < tableSize + attSizes[nr_att - 1]; i++)
+    n->count[i] = 0;
+  n->remain = remain;
+  n->nr_new = 0;
+  return nr_node++;
+}
+
+void Hoeffding::trySplit(int index) {
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  HoeffNode *n = &node[index];
+  const long *class_cnt = n->count + tableSize;
+
+  // pure leaf has nothing to gain
+  double nr_ex = 0;
+  int nr_kind = 0;
+  for (ATTVAL c = 0; c < nr_class; c++) {
+    nr_ex += class_cnt[c];
+    if (class_cnt[c] > 0)
+      nr_kind++;
+  }
+  if (nr_kind <= 1)
+    return;
+  double total = entropy(class_cnt, nr_class, nr_ex);
+
+  // the same Gain as ID3::calGain(); not splitting is a rival of gain 0
+  ATTINDEX best = -1;
+  double first = 0, second = 0;
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+    if (!n->remain[a])
+      continue;
+    double gain = total;
+    for (ATTVAL v = 0; v < attSizes[a]; v++) {
+      const long *val_cnt = n->count + tableOffset[a] + v * nr_class;
+      double nr_val = 0;
+      for (ATTVAL c = 0; c < nr_class; c++)
+        nr_val += val_cnt[c];
+      gain -= (nr_val / nr_ex) * entropy(val_cnt, nr_class, nr_val);
+    }
+    if (best == -1 || gain > first) {
+      second = first;
+      first = gain;
+      best = a;
+    }
+    else if (gain > second)
+      second = gain;
+  }
+  if (best == -1 || first <= 0)
+    return;
+
+  // Gain ranges over log2( nr_class ); with probability 1 - delta the
+  // true best attr is the one seen when the gap beats epsilon
+  double range = log((double) nr_class) / log((double) 2);
+  double epsilon = sqrt(range * range * log(1 / delta) / (2 * nr_ex));
+  if (first - second <= epsilon && epsilon >= HOEFF_TIE)
+    return;
+
+  // children start empty; they answer the majority their value had here
+  long *count = n->count;
+  bool *remain = n->remain;
+  int depth = n->depth;
+  ATTVAL most = major(class_cnt, nr_class);
+  n->att = best;
+  n->child = nr_node;
+  n->val = most; // for pruning
+  n->count = NULL;
+  n->remain = NULL;
+  for (ATTVAL v = 0; v < attSizes[best]; v++) {
+    bool *sub = new bool[nr_att - 1];
+    for (ATTINDEX a = 0; a < nr_att - 1; a++)
+      sub[a] = remain[a];
+    sub[best] = false;
+    ATTVAL val = major(count + tableOffset[best] + v * nr_class, nr_class);
+    if (val < 0)
+      val = most;
+    newLeaf(depth + 1, val, sub); // node may move; n is not used after
+  }
+  delete [] count;
+  delete [] remain;
+  nr_split++;
+}
+
+void Hoeffding::addRow(const ATTVAL *row) {
+  ASSERT (row != NULL, (char*) "addRow condition error");
+  for (ATTINDEX a = 0; a < nr_att; a++)
+    ASSERT (row[a] >= 0 && row[a] < attSizes[a], (char*) "attribute value is out of range");
+
+  int index = 0;
+  while (node[index].att >= 0)
+    index = node[index].child + row[node[index].att];
+
+  // only the leaf keeps counts; the row is not kept anywhere
+  HoeffNode *n = &node[index];
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  ATTVAL target = row[nr_att - 1];
+  for (ATTINDEX a = 0; a < nr_att - 1; a++)
+    n->count[tableOffset[a] + row[a] * nr_class + target]++;
+  n->count[tableSize + target]++;
+  nr_row++;
+
+  if (++n->nr_new < grace)
+    return;
+  n->nr_new = 0;
+  if (maxDepth > 0 && n->depth >= maxDepth) // deep enough
+    return;
+  trySplit(index);
+}
+
+DTreeNode* Hoeffding::build(int index) const {
+  const HoeffNode *n = &node[index];
+  if (n->att == -1) {
+    ATTVAL val = major(n->count + tableSize, attSizes[nr_att - 1]);
+    return new DTreeLeaf((val >= 0) ? val : n->val);
+  }
+
+  DTreeRoot *link = new DTreeRoot(n->att, new DTreeNode*[attSizes[n->att]],
+    attSizes[n->att]);
+  link->setMajor(n->val);
+  for (ATTVAL v = 0; v < attSizes[n->att]; v++)
+    link->setOneChild(build(n->child + v), v);
+  return link;
+}
@@ -0,0 +1,565 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file incremental.cpp
+/// @brief Incremental Decision Tree Library Source File
+/// @details ID5R restructuring tree by pull-ups, lazily as ITI does.
+///
+/// @section reference_section Reference
+/// INCREMENTAL INDUCTION OF DECISION TREES - PAUL E. UTGOFF
+/// DECISION TREE INDUCTION BASED ON EFFICIENT TREE RESTRUCTURING - PAUL E.
+/// UTGOFF, NEIL C. BERKMAN, JEFFERY A. CLOUSE
+///
+/// @section purpose_section Purpose
+/// Application trial for personal studying
+///
+
+#include "incremental.h"
+#include "assertion.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// ID5R class implementation
+///
+
+#define ID5R_ROWS     1024  ///< initial capacity of row store
+#define ID5R_REBUILD  1024  ///< rows under which subtree is rebuilt instead of pulled up
+
+/// @brief node of incremental tree
+struct ID5RNode {
+  ATTINDEX  att;          ///< test attr ( -1 for leaf )
+  ID5RNode  **child;      ///< children, one per value of att ( NULL for leaf )
+  int       *count;       ///< count table of rows under node ( class counts follow )
+  int       *rows;        ///< row ids kept at leaf ( NULL if none )
+  int       nr_row;       ///< the number of row ids kept at leaf
+  int       max_row;      ///< capacity of rows
+  bool      stale;        ///< true if counts changed since test was checked
+};
+
+/// @brief entropy of class counts as ID3::calEntropy() takes it
+static double entropy(const int *class_cnt, ATTVAL nr_class, double nr_ex) {
+  if (nr_ex <= 0)
+    return 0;
+  double e = 0;
+  for (ATTVAL c = 0; c < nr_class; c++) {
+    if (class_cnt[c] <= 0)
+      continue;
+    double p = ((double) class_cnt[c]) / nr_ex;
+    e += -p * log(p) / log((double) 2);
+  }
+  return e;
+}
+
+/// @brief the most common class; the smallest value wins a tie
+static ATTVAL major(const int *class_cnt, ATTVAL nr_class) {
+  int most = 0;
+  ATTVAL val = -1;
+  for (ATTVAL c = 0; c < nr_class; c++) {
+    if (most < class_cnt[c]) {
+      most = class_cnt[c];
+      val = c;
+    }
+  }
+  return val;
+}
+
+/// @brief copy of remaining attr flags without one attr
+static bool* without(const bool *remain, ATTINDEX nr, ATTINDEX att) {
+  bool *copy = new bool[nr];
+  for (ATTINDEX a = 0; a < nr; a++)
+    copy[a] = remain[a];
+  copy[att] = false;
+  return copy;
+}
+
+ID5R::ID5R(ATTVAL *attSizes, ATTINDEX nr_att) {
+  ASSERT (attSizes != NULL && nr_att > 1 && attSizes[nr_att - 1] > 0,
+    (char*) "ID5R condition error");
+  for (ATTINDEX a = 0; a < nr_att - 1; a++)
+    ASSERT (attSizes[a] > 0, (char*) "ID5R needs nominal attributes");
+  this->attSizes = attSizes;
+  this->nr_att = nr_att;
+
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  tableOffset = new int[nr_att - 1];
+  tableSize = 0;
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+    tableOffset[a] = tableSize;
+    tableSize += attSizes[a] * nr_class;
+  }
+
+  max_row = ID5R_ROWS;
+  nr_row = 0;
+  rows = new ATTVAL[max_row * nr_att];
+  nr_restruct = 0;
+  root = newLeaf();
+}
+
+ID5R::~ID5R() {
+  freeNode(root);
+  delete [] rows;
+  delete [] tableOffset;
+}
+
+DTree* ID5R::makeDTree() {
+  ATTVAL nr_class = attSizes[nr_att - 1];
+
+  // deferred restructuring; only paths rows went down are checked
+  if (root->stale) {
+    bool *remain = new bool[nr_att - 1];
+    for (ATTINDEX a = 0; a < nr_att - 1; a++)
+      remain[a] = true;
+    ensureBest(root, remain);
+    delete [] remain;
+  }
+  ATTVAL *sizes = new ATTVAL[nr_att]; // tree frees it
+  for (ATTINDEX a = 0; a < nr_att; a++)
+    sizes[a] = attSizes[a];
+
+  // empty leaf gets the most common value of all rows as ID3 does
+  ATTVAL empty = major(root->count + tableSize, nr_class);
+  return new DTree(build(root, (empty >= 0) ? empty : 0), sizes, nr_att);
+}
+
+int ID5R::getNrRow() const {
+  return nr_row;
+}
+
+int ID5R::getNrRestruct() const {
+  return nr_restruct;
+}
+
+int ID5R::getNrNode() const {
+  return countNode(root);
+}
+
+ID5RNode* ID5R::newLeaf() {
+  ID5RNode *n = new ID5RNode;
+  n->att = -1;
+  n->child = NULL;
+  n->count = new int[tableSize + attSizes[nr_att - 1]];
+  for (int i = 0; i < tableSize + attSizes[nr_att - 1]; i++)
+    n->count[i] = 0;
+  n->rows = NULL;
+  n->nr_row = 0;
+  n->max_row = 0;
+  n->stale = false;
+  return n;
+}
+
+void ID5R::freeNode(ID5RNode *n) {
+  if (n->child) {
+    for (ATTVAL v = 0; v < attSizes[n->att]; v++)
+      freeNode(n->child[v]);
+    delete [] n->child;
+  }
+  if (n->rows)
+    delete [] n->rows;
+  delete [] n->count;
+  delete (n);
+}
+
+void ID5R::count(ID5RNode *n, const ATTVAL *row) {
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  ATTVAL target = row[nr_att - 1];
+  for (ATTINDEX a = 0; a < nr_att - 1; a++)
+    n->count[tableOffset[a] + row[a] * nr_class + target]++;
+  n->count[tableSize + target]++;
+}
+
+void ID5R::keep(ID5RNode *n, int id) {
+  if (n->nr_row == n->max_row) {
+    int max = (n->max_row > 0) ? n->max_row * 2 : 4;
+    int *bigger = new int[max];
+    for (int i = 0; i < n->nr_row; i++)
+      bigger[i] = n->rows[i];
+    if (n->rows)
+      delete [] n->rows;
+    n->rows = bigger;
+    n->max_row = max;
+  }
+  n->rows[n->nr_row++] = id;
+}
+
+bool ID5R::pure(const ID5RNode *n) const {
+  int nr_kind = 0;
+  for (ATTVAL c = 0; c < attSizes[nr_att - 1]; c++)
+    if (n->count[tableSize + c] > 0)
+      nr_kind++;
+  return nr_kind <= 1;
+}
+
+ATTINDEX ID5R::bestAtt(const ID5RNode *n, const bool *remain) const {
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  const int *class_cnt = n->count + tableSize;
+  double nr_ex = 0;
+  for (ATTVAL c = 0; c < nr_class; c++)
+    nr_ex += class_cnt[c];
+  double total = entropy(class_cnt, nr_class, nr_ex);
+
+  // the same Gain as ID3::calGain(); the lowest index wins a tie
+  ATTINDEX best = -1;
+  double max_gain = 0;
+  for (ATTINDEX a = 0; a < nr_att - 1; a++) {
+    if (!remain[a])
+      continue;
+    double gain = total;
+    for (ATTVAL v = 0; v < attSizes[a]; v++) {
+      const int *val_cnt = n->count + tableOffset[a] + v * nr_class;
+      double nr_val = 0;
+      for (ATTVAL c = 0; c < nr_class; c++)
+        nr_val += val_cnt[c];
+      gain -= (nr_val / nr_ex) * entropy(val_cnt, nr_class, nr_val);
+    }
+    if (best == -1 || gain > max_gain) {
+      max_gain = gain;
+      best = a;
+    }
+  }
+  return best;
+}
+
+void ID5R::expand(ID5RNode *n, ATTINDEX att) {
+  ASSERT (n->att == -1, (char*) "only leaf can be expanded");
+  n->att = att;
+  n->child = new ID5RNode*[attSizes[att]];
+  for (ATTVAL v = 0; v < attSizes[att]; v++)
+    n->child[v] = newLeaf();
+  for (int i = 0; i < n->nr_row; i++) {
+    const ATTVAL *row = rows + (long) n->rows[i] * nr_att;
+    ID5RNode *c = n->child[row[att]];
+    count(c, row);
+    keep(c, n->rows[i]);
+  }
+  if (n->rows)
+    delete [] n->rows;
+  n->rows = NULL;
+  n->nr_row = 0;
+  n->max_row = 0;
+}
+
+void ID5R::gather(ID5RNode *n, ID5RNode *leaf) {
+  if (n->att == -1) {
+    for (int i = 0; i < n->nr_row; i++)
+      keep(leaf, n->rows[i]);
+    return;
+  }
+  for (ATTVAL v = 0; v < attSizes[n->att]; v++)
+    gather(n->child[v], leaf);
+}
+
+void ID5R::collapse(ID5RNode *n) {
+  ASSERT (n->att >= 0, (char*) "only test node can be collapsed");
+  for (ATTVAL v = 0; v < attSizes[n->att]; v++) {
+    gather(n->child[v], n);
+    freeNode(n->child[v]);
+  }
+  delete [] n->child;
+  n->child = NULL;
+  n->att = -1;
+}
+
+void ID5R::pullUp(ID5RNode *n, ATTINDEX att, const bool *remain) {
+  ATTINDEX old = n->att;
+  ASSERT (old >= 0 && old != att, (char*) "pullUp condition error");
+  int size = tableSize + attSizes[nr_att - 1];
+
+  // every child tests att first; its children are made consistent again
+  bool *sub = without(remain, nr_att - 1, old);
+  bool *grand = without(sub, nr_att - 1, att);
+  for (ATTVAL v = 0; v < attSizes[old]; v++) {
+    ID5RNode *c = n->child[v];
+    if (c->att == att)
+      continue;
+    if (c->att == -1)
+      expand(c, att);
+    else
+      pullUp(c, att, sub);
+    for (ATTVAL w = 0; w < attSizes[att]; w++)
+      ensureBest(c->child[w], grand);
+  }
+
+  // transposition; grandchild ( w, v ) moves under new child w
+  ID5RNode **child = new ID5RNode*[attSizes[att]];
+  for (ATTVAL w = 0; w < attSizes[att]; w++) {
+    ID5RNode *m = newLeaf();
+    m->att = old;
+    m->child = new ID5RNode*[attSizes[old]];
+    for (ATTVAL v = 0; v < attSizes[old]; v++) {
+      ID5RNode *g = n->child[v]->child[w];
+      m->child[v] = g;
+      for (int i = 0; i < size; i++)
+        m->count[i] += g->count[i];
+    }
+    child[w] = m;
+  }
+  for (ATTVAL v = 0; v < attSizes[old]; v++) { // old children are empty shells
+    delete [] n->child[v]->child;
+    n->child[v]->child = NULL;
+    n->child[v]->att = -1;
+    freeNode(n->child[v]);
+  }
+  delete [] n->child;
+  n->child = child;
+  n->att = att;
+  nr_restruct++;
+
+  delete [] sub;
+  delete [] grand;
+}
+
+void ID5R::ensureBest(ID5RNode *n, const bool *remain) {
+  n->stale = false;
+  if (n->att == -1) { // impure leaf splits while attrs are left
+    if (pure(n))
+      return;
+    ATTINDEX best = bestAtt(n, remain);
+    if (best == -1)
+      return;
+    expand(n, best);
+    bool *sub = without(remain, nr_att - 1, best);
+    for (ATTVAL v = 0; v < attSizes[best]; v++)
+      ensureBest(n->child[v], sub);
+    delete [] sub;
+    return;
+  }
+
+  if (pure(n)) { // no split is needed any more
+    collapse(n);
+    return;
+  }
+  // test is kept unless another attr is better; then children not
+  // changed since their last check are consistent already
+  ATTINDEX best = bestAtt(n, remain);
+  bool keep = best == n->att;
+  int nr_ex = 0;
+  for (ATTVAL c = 0; c < attSizes[nr_att - 1]; c++)
+    nr_ex += n->count[tableSize + c];
+  if (!keep && nr_ex < ID5R_REBUILD) { // small subtree is made again from rows
+    collapse(n);
+    ensureBest(n, remain);
+    return;
+  }
+  if (!keep)
+    pullUp(n, best, remain);
+  bool *sub = without(remain, nr_att - 1, best);
+  for (ATTVAL v = 0; v < attSizes[best]; v++)
+    if (!keep || n->child[v]->stale)
+      ensureBest(n->child[v], sub);
+  delete [] sub;
+}
+
+void ID5R::addRow(const ATTVAL *row) {
+  ASSERT (row != NULL, (char*) "addRow condition error");
+  for (ATTINDEX a = 0; a < nr_att; a++)
+    ASSERT (row[a] >= 0 && row[a] < attSizes[a], (char*) "attribute value is out of range");
+
+  if (nr_row == max_row) {
+    ATTVAL *bigger = new ATTVAL[(long) max_row * 2 * nr_att];
+    for (long i = 0; i < (long) nr_row * nr_att; i++)
+      bigger[i] = rows[i];
+    delete [] rows;
+    rows = bigger;
+    max_row *= 2;
+  }
+  for (ATTINDEX a = 0; a < nr_att; a++)
+    rows[(long) nr_row * nr_att + a] = row[a];
+
+  // counts are updated down the current path only; tests are checked
+  // when a tree is made
+  ID5RNode *n = root;
+  const ATTVAL *cur = rows + (long) nr_row * nr_att;
+  while (true) {
+    count(n, cur);
+    n->stale = true;
+    if (n->att == -1)
+      break;
+    n = n->child[cur[n->att]];
+  }
+  keep(n, nr_row++);
+}
+
+DTreeNode* ID5R::build(const ID5RNode *n, ATTVAL empty) const {
+  ATTVAL nr_class = attSizes[nr_att - 1];
+  ATTVAL val = major(n->count + tableSize, nr_class);
+  if (n->att == -1)
+    return new DTreeLeaf((val >= 0) ? val : empty);
+
+  DTreeRoot *link = new DTreeRoot(n->att, new DTreeNode*[attSizes[n->att]],
+    attSizes[n->att]);
+  link->setMajor(val);
+  for (ATTVAL v = 0; v < attSizes[n->att]; v++)
+    link->setOneChild(build(n->child[v], empty), v);
+  return link;
+}
+
+int ID5R::countNode(const ID5RNode *n) const {
+  int nr = 1;
+  if (n->att >= 0)
+    for (ATTVAL v = 0; v < attSizes[n->att]; v++)
+      nr += countNode(n->child[v]);
+  return nr;
+}
+
+ID5RNode* ID5R::shapeNode(const int *shape, int nr_shape, int &pos, bool *remain) {
+  if (pos >= nr_shape)
+    return NULL;
+  ATTINDEX att = shape[pos++];
+  ID5RNode *n = newLeaf();
+  if (att == -1)
+    return n;
+  if (att < 0 || att >= nr_att - 1 || !remain[att]) { // test attr is used once on path
+    freeNode(n);
+    return NULL;
+  }
+
+  n->att = att;
+  n->child = new ID5RNode*[attSizes[att]];
+  for (ATTVAL v = 0; v < attSizes[att]; v++)
+    n->child[v] = NULL;
+  remain[att] = false;
+  bool good = true;
+  for (ATTVAL v = 0; good && v < attSizes[att]; v++) {
+    n->child[v] = shapeNode(shape, nr_shape, pos, remain);
+    good = n->child[v] != NULL;
+  }
+  remain[att] = true;
+  if (good)
+    return n;
+
+  // free what was made; missing children are leaves for freeNode()
+  for (ATTVAL v = 0; v < attSizes[att]; v++)
+    if (!n->child[v])
+      n->child[v] = newLeaf();
+  freeNode(n);
+  return NULL;
+}
+
+#define ID5R_MAGIC    "namiIT\n"  ///< state file magic ( 8 bytes with NUL )
+#define ID5R_VERSION  1           ///< state file format version
+
+/// @brief binary state file header
+struct ID5RHeader {
+  char  magic[8];     ///< ID5R_MAGIC
+  int   version;      ///< ID5R_VERSION
+  int   nr_att;       ///< the number of attributes including target attr
+  int   nr_row;       ///< the number of rows
+  int   nr_node;      ///< the number of nodes
+};
+
+/// @brief test attr of each node in preorder ( -1 for leaf )
+static void save_shape(const ID5RNode *n, const ATTVAL *attSizes, int *shape,
+    int &pos) {
+  shape[pos++] = n->att;
+  if (n->att >= 0)
+    for (ATTVAL v = 0; v < attSizes[n->att]; v++)
+      save_shape(n->child[v], attSizes, shape, pos);
+}
+
+bool ID5R::save(const char *path) const {
+  ASSERT (path != NULL, (char*) "state path is NULL");
+
+  ofstream file(path, ios::out | ios::binary | ios::trunc);
+  if (!file.is_open())
+    return false;
+
+  ID5RHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, ID5R_MAGIC, sizeof(header.magic));
+  header.version = ID5R_VERSION;
+  header.nr_att = nr_att;
+  header.nr_row = nr_row;
+  header.nr_node = countNode(root);
+  int *shape = new int[header.nr_node];
+  int pos = 0;
+  save_shape(root, attSizes, shape, pos);
+
+  file.write((const char*) &header, sizeof(header));
+  file.write((const char*) attSizes, nr_att * sizeof(ATTVAL));
+  file.write((const char*) rows, (long) nr_row * nr_att * sizeof(ATTVAL));
+  file.write((const char*) shape, header.nr_node * sizeof(int));
+  file.close();
+  delete [] shape;
+
+  return !file.fail();
+}
+
+ID5R* ID5R::load(const char *path, ATTVAL **attSizes, ATTINDEX *nr_att) {
+  ASSERT (path != NULL && attSizes != NULL && nr_att != NULL,
+    (char*) "load condition error");
+
+  ifstream file(path, ios::in | ios::binary);
+  if (!file.is_open())
+    return NULL;
+  ID5RHeader header;
+  file.read((char*) &header, sizeof(header));
+  if (file.gcount() != sizeof(header) ||
+      memcmp(header.magic, ID5R_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != ID5R_VERSION || header.nr_att < 2 ||
+      header.nr_att > (1 << 20) || header.nr_row < 0 || header.nr_row > (1 << 30) ||
+      header.nr_node < 1 || header.nr_node > (1 << 30))
+    return NULL;
+
+  // sizes and values are checked here, since constructor and addRow() exit
+  ATTVAL *sizes = new ATTVAL[header.nr_att];
+  file.read((char*) sizes, header.nr_att * sizeof(ATTVAL));
+  bool good = file.gcount() == (long) (header.nr_att * sizeof(ATTVAL));
+  for (ATTINDEX a = 0; good && a < header.nr_att; a++)
+    good = sizes[a] > 0;
+  ATTVAL *data = NULL;
+  int *shape = NULL;
+  if (good) {
+    long nr_val = (long) header.nr_row * header.nr_att;
+    data = new ATTVAL[nr_val + 1];
+    file.read((char*) data, nr_val * sizeof(ATTVAL));
+    good = file.gcount() == (long) (nr_val * sizeof(ATTVAL));
+    for (long i = 0; good && i < nr_val; i++)
+      good = data[i] >= 0 && data[i] < sizes[i % header.nr_att];
+  }
+  if (good) {
+    shape = new int[header.nr_node];
+    file.read((char*) shape, header.nr_node * sizeof(int));
+    good = file.gcount() == (long) (header.nr_node * sizeof(int)) &&
+      file.peek() == EOF;
+  }
+
+  ID5R *id5r = NULL;
+  if (good) {
+    id5r = new ID5R(sizes, header.nr_att);
+    bool *remain = new bool[header.nr_att - 1];
+    for (ATTINDEX a = 0; a < header.nr_att - 1; a++)
+      remain[a] = true;
+    int pos = 0;
+    ID5RNode *root = id5r->shapeNode(shape, header.nr_node, pos, remain);
+    delete [] remain;
+    if (root && pos == header.nr_node) {
+      id5r->freeNode(id5r->root);
+      id5r->root = root;
+      for (int r = 0; r < header.nr_row; r++) // counts are made again on the path
+        id5r->addRow(data + (long) r * header.nr_att);
+    } else {
+      if (root)
+        id5r->freeNode(root);
+      delete (id5r);
+      id5r = NULL;
+    }
+  }
+
+  if (data)
+    delete [] data;
+  if (shape)
+    delete [] shape;
+  if (!id5r) {
+    delete [] sizes;
+    return NULL;
+  }
+  *attSizes = sizes;
+  *nr_att = header.nr_att;
+  return id5r;
+}
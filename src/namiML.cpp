@@ -28,8 +28,13 @@
 
 #include <iomanip>      ///< for managing console output
 #include <cstdlib>      ///< for exit() & rand() & srand()
+#include <cstdio>       ///< for rename()
 #include <cstring>      ///< string compare
 #include <ctime>        ///< for time()
+#include <cmath>        ///< for log()
+#include <string>       ///< for export path
+#include <unistd.h>     ///< for fork() & execvp()
+#include <sys/wait.h>   ///< for waitpid()
 #include "namiML.h"
 
 #define VERSION "v0.5"
@@ -51,35 +56,86 @@ void namiTerm(void) {
 /// 
 /// @brief print help message
 void printHelp(void) {
-  cout <<    "///" << "  Usage: namiML <-g / -p> -m [MODE] -i [INPUT] -t [T-DATA] (-o [OUTPUT]) (-x [ANSWER])"
+  cout <<    "///" << "  Usage: namiML <-g / -p / -q> -m [MODE] -i [INPUT] -t [T-DATA] (-o [OUTPUT]) (-x [ANSWER]) (-j [THREAD]) (-w) (-b [BINS]) (-n [TREES]) (-d [DEPTH]) (-c [LEVEL]) (-r [ROWS]) (-k [NODES]) (-u [MSEC]) (-e [EXPORT]) (-s / -l [MODEL]) (-v [FOLDS]) (-a) (-z [DELTA]) (-y [ROWS]) (-f [ROWS])"
   << endl << "///"
   << endl << "///" << "  < Example > :"
   << endl << "///" << "              namiML -g -m concept"
   << endl << "///" << "              namiML -g -m decision -i input.txt -t train.txt -o answer.txt"
   << endl << "///" << "              namiML -p -m concept -i input.txt -t train.txt -o output.txt -x answer.txt"
   << endl << "///" << "              namiML -p -m decision -i data/IN.txt -t data/TRAIN.txt"
+  << endl << "///" << "              namiML -p -m decision -i data/IN.txt -l model.bin"
+  << endl << "///" << "              namiML -p -m decision -i data/IN.txt -t data/TRAIN.txt -b 64"
+  << endl << "///" << "              namiML -p -m decision -i data/IN.txt -t data/TRAIN.txt -w"
+  << endl << "///" << "              namiML -p -m decision -i data/IN.txt -t data/TRAIN.txt -a"
+  << endl << "///" << "              namiML -p -m decision -i data/IN.txt -t data/TRAIN.txt -c 0.01 -r 8"
+  << endl << "///" << "              namiML -p -m decision -i data/IN.txt -t data/TRAIN.txt -k 255 -u 500"
+  << endl << "///" << "              namiML -p -m decision -i data/IN.txt -t data/TRAIN.txt -v 10 -d 8"
+  << endl << "///" << "              namiML -p -m forest -i data/IN.txt -t data/TRAIN.txt -n 100"
+  << endl << "///" << "              namiML -p -m boost -i data/IN.txt -t data/TRAIN.txt -n 200 -d 2"
+  << endl << "///" << "              namiML -p -m disk -i data/IN.txt -t data/HUGE.txt -s model.bin"
+  << endl << "///" << "              namiML -p -m id5r -i data/IN.txt -t data/NEW.txt -l state.bin -s state.bin"
+  << endl << "///" << "              namiML -p -m hoeffding -i data/IN.txt -t /dev/stdin -z 0.001 -y 500 -s model.bin -f 100000"
+  << endl << "///" << "              namiML -q -m concept -i seed.txt -t train.txt -x answer.txt"
   << endl << "///"
   << endl << "///" << "  OPTION LIST ; Each option must be only one or not"
   << endl << "///"
   << endl << "///" << "    -g       generate a training data file and a new instance file (output means answer)"
   << endl << "///" << "    -p       predict output about given input data and training data"
+  << endl << "///" << "    -q       learn with optimal queries to answer file as an oracle (-t : queried data)"
   << endl << "///" << "    -h       print this help message (no other options)"
   << endl << "///" << "    -m       choose machine learning mode"
-  << endl << "///" << "    -i       choose a new instance file (-g option default : ./input.txt)"
+  << endl << "///" << "    -i       choose a new instance file (-g option default : ./input.txt, -q : seed data)"
   << endl << "///" << "    -t       choose a training data file (-g option default : ./train.txt)"
   << endl << "///" << "    -o       determine an output file name (-p option default : ./output.txt, -g : ./answer.txt)"
-  << endl << "///" << "    -x       perfomance test for generated input & train set (only with predict)"
+  << endl << "///" << "    -x       perfomance test for generated input & train set (predict), oracle (query)"
+  << endl << "///" << "    -j       choose the number of threads (default : the number of cores)"
+  << endl << "///" << "    -w       grow decision trees level by level (breadth first, -p only, no -l)"
+  << endl << "///" << "    -a       count small-domain attributes by bitmap index, AND and popcount (decision -p only, no -l)"
+  << endl << "///" << "    -b       split high-cardinality and continuous attributes on histogram bins (-p only, no -l)"
+  << endl << "///" << "    -n       choose the number of trees in forest or boosting rounds (-p only, default : 64)"
+  << endl << "///" << "    -d       choose the maximum depth of decision trees (-p only, boost default : 1)"
+  << endl << "///" << "    -c       stop splitting when chi-square test of split is not significant at level (-p only, no -l, no hoeffding)"
+  << endl << "///" << "    -r       stop splitting nodes having fewer rows than this (-p only, no -l, no hoeffding)"
+  << endl << "///" << "    -k       grow decision tree best first up to this many nodes (decision -p only, no -l, no -w)"
+  << endl << "///" << "    -u       grow decision tree best first for this many milliseconds (decision -p only, no -l, no -w)"
+  << endl << "///" << "    -v       report k-fold cross validation accuracy before training (decision -p only, no -l)"
+  << endl << "///" << "    -z       choose the chance of a wrong split of streaming tree (hoeffding -p only, default : 1e-7)"
+  << endl << "///" << "    -y       choose the rows a leaf takes between split checks (hoeffding -p only, default : 200)"
+  << endl << "///" << "    -f       save the model file of -s again every this many rows while streaming (hoeffding -p only)"
+  << endl << "///" << "    -e       export trained decision tree as C++ source (.so : shared object, -p only)"
+  << endl << "///" << "    -s       save trained decision tree as binary model file (-p only; id5r saves its state)"
+  << endl << "///" << "    -l       load binary model file instead of training (-p only, no -t; id5r adds -t rows to loaded state)"
   << endl << "///"
   << endl << "///" << "  [MODE]     mode type"
   << endl << "///" << "  [INPUT]    input file name"
   << endl << "///" << "  [T-DATA]   training data file name"
   << endl << "///" << "  [OUTPUT]   output file name (-g default : ./output.txt, -p default : ./answer.txt)"
   << endl << "///" << "  [ANSWER]   answer file name for generated examples"
+  << endl << "///" << "  [THREAD]   the number of threads"
+  << endl << "///" << "  [BINS]     the maximum number of bins per attribute (at least 2)"
+  << endl << "///" << "  [TREES]    the number of trees"
+  << endl << "///" << "  [DEPTH]    the maximum depth of tree (at least 1)"
+  << endl << "///" << "  [LEVEL]    significance level of chi-square test (between 0 and 1, e.g. 0.05)"
+  << endl << "///" << "  [DELTA]    probability of a wrong split (between 0 and 1, e.g. 0.001)"
+  << endl << "///" << "  [ROWS]     the minimum number of rows to split a node (at least 2)"
+  << endl << "///" << "  [NODES]    the maximum number of tree nodes (at least 1)"
+  << endl << "///" << "  [MSEC]     time budget in milliseconds (at least 1)"
+  << endl << "///" << "  [FOLDS]    the number of cross validation folds (at least 2)"
+  << endl << "///" << "  [EXPORT]   exported source or shared object file name"
+  << endl << "///" << "  [MODEL]    binary model file name"
   << endl << "///"
   << endl << "///" << "  MODE LIST"
   << endl << "///"
   << endl << "///" << "    " << setw(10) << left << "concept" << "  concept learning algorithm"
   << endl << "///" << "    " << setw(10) << left << "decision" << "  decision tree algorithm"
+  << endl << "///" << "    " << setw(10) << left << "forest" << "  random forest of decision trees"
+  << endl << "///" << "    " << setw(10) << left << "boost" << "  AdaBoost of shallow decision trees"
+  << endl << "///" << "    " << setw(10) << left << "disk" << "  out-of-core decision tree streaming training file per level"
+  << endl << "///" << "    " << setw(10) << left << "id5r" << "  incremental decision tree updated row by row (nominal attributes only)"
+  << endl << "///" << "    " << setw(10) << left << "hoeffding" << "  streaming decision tree seeing each row once (nominal attributes only)"
+  << endl << "///"
+  << endl << "///" << "  Every value is an integer. Continuous attribute ( size 0 ) takes signed"
+  << endl << "///" << "  integers, so real values must be scaled to integers ( e.g. x1000 ) first."
   << endl;
 }
 
@@ -100,8 +156,8 @@ void printError(const char* message) {
 /// 
 /// @brief global valid option information
 ///
-static char gl_valid_option_set[] = { 'g', 'p', 'm', 'i', 't', 'o', 'h', 'x' };
-static int gl_num_valid_option = 8;
+static char gl_valid_option_set[] = { 'g', 'p', 'q', 'm', 'i', 't', 'o', 'h', 'x', 'j', 'e', 's', 'l', 'b', 'n', 'd', 'w', 'c', 'r', 'k', 'u', 'v', 'a', 'z', 'y', 'f' };
+static int gl_num_valid_option = 26;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// 
@@ -163,18 +219,26 @@ bool isOptionValid(int argc, char* argv[]) {
         return false;
       }
 
-      // single option handling ('g', 'p', 'h')
+      // single option handling ('g', 'p', 'q', 'h', 'w', 'a')
       if (argv[i][1] == 'h' && argc > 2) {
         printError("HELP OPTION COME ALONE");
         return false;
       }
-      if (argv[i][1] == 'g' || argv[i][1] == 'p')
+      if (argv[i][1] == 'g' || argv[i][1] == 'p' || argv[i][1] == 'q' || \
+          argv[i][1] == 'w' || argv[i][1] == 'a')
         continue;
       
-      // couple option handling ('m', 'i', 't', 'o')
+      // couple option handling ('m', 'i', 't', 'o', 'x', 'j', 'e', 's', 'l', 'b', 'n', 'd', 'c', 'r', 'k', 'u', 'v', 'z', 'y', 'f')
       if (argv[i][1] == 'm' || argv[i][1] == 'i' || \
           argv[i][1] == 't' || argv[i][1] == 'o' || \
-          argv[i][1] == 'x') {
+          argv[i][1] == 'x' || argv[i][1] == 'j' || \
+          argv[i][1] == 'e' || argv[i][1] == 's' || \
+          argv[i][1] == 'l' || argv[i][1] == 'b' || \
+          argv[i][1] == 'n' || argv[i][1] == 'd' || \
+          argv[i][1] == 'c' || argv[i][1] == 'r' || \
+          argv[i][1] == 'k' || argv[i][1] == 'u' || \
+          argv[i][1] == 'v' || argv[i][1] == 'z' || \
+          argv[i][1] == 'y' || argv[i][1] == 'f') {
         // check if there is second option
         if (i >= (argc - 1)) { // check if this option is the last one
           printError("THERE IS NO SECOND OPTION");
@@ -194,14 +258,194 @@ bool isOptionValid(int argc, char* argv[]) {
   if (findOption('h', argc, argv)) // help logical check
     return true;
 
+  if (findOption('e', argc, argv) && !findOption('p', argc, argv)) {
+    printError("EXPORT IS ONLY PROCESSING WITH PREDICTION");
+    return false;
+  }
+
+  if ((findOption('s', argc, argv) || findOption('l', argc, argv)) && \
+      !findOption('p', argc, argv)) {
+    printError("MODEL FILE IS ONLY PROCESSING WITH PREDICTION");
+    return false;
+  }
+
+  if (int bIndex = findOption('b', argc, argv)) {
+    if (!findOption('p', argc, argv) || findOption('l', argc, argv)) {
+      printError("HISTOGRAM IS ONLY PROCESSING WITH TRAINING FOR PREDICTION");
+      return false;
+    }
+    if (atoi(argv[bIndex + 1]) < 2) {
+      printError("HISTOGRAM NEEDS TWO BINS AT LEAST");
+      return false;
+    }
+  }
+
+  if (int nIndex = findOption('n', argc, argv)) {
+    if (!findOption('p', argc, argv)) {
+      printError("THE NUMBER OF TREES IS ONLY PROCESSING WITH PREDICTION");
+      return false;
+    }
+    if (atoi(argv[nIndex + 1]) < 1) {
+      printError("FOREST NEEDS ONE TREE AT LEAST");
+      return false;
+    }
+  }
+
+  if (findOption('w', argc, argv) && \
+      (!findOption('p', argc, argv) || findOption('l', argc, argv))) {
+    printError("LEVEL-WISE GROWTH IS ONLY PROCESSING WITH TRAINING FOR PREDICTION");
+    return false;
+  }
+
+  if (int dIndex = findOption('d', argc, argv)) {
+    if (!findOption('p', argc, argv)) {
+      printError("TREE DEPTH IS ONLY PROCESSING WITH PREDICTION");
+      return false;
+    }
+    if (atoi(argv[dIndex + 1]) < 1) {
+      printError("TREE NEEDS ONE LEVEL AT LEAST");
+      return false;
+    }
+  }
+
+  int hIndex = findOption('m', argc, argv);
+  bool hoeffding = hIndex && strcmp(argv[hIndex + 1], "hoeffding") == 0;
+
+  if (int cIndex = findOption('c', argc, argv)) {
+    if (!findOption('p', argc, argv) || findOption('l', argc, argv)) {
+      printError("PRE-PRUNING IS ONLY PROCESSING WITH TRAINING FOR PREDICTION");
+      return false;
+    }
+    if (hoeffding) {
+      printError("HOEFFDING TREE TAKES -z FOR THE CHANCE OF A WRONG SPLIT");
+      return false;
+    }
+    double level = atof(argv[cIndex + 1]);
+    if (level <= 0 || level >= 1) {
+      printError("SIGNIFICANCE LEVEL MUST BE BETWEEN 0 AND 1");
+      return false;
+    }
+  }
+
+  if (int rIndex = findOption('r', argc, argv)) {
+    if (!findOption('p', argc, argv) || findOption('l', argc, argv)) {
+      printError("PRE-PRUNING IS ONLY PROCESSING WITH TRAINING FOR PREDICTION");
+      return false;
+    }
+    if (hoeffding) {
+      printError("HOEFFDING TREE TAKES -y FOR THE ROWS BETWEEN SPLIT CHECKS");
+      return false;
+    }
+    if (atoi(argv[rIndex + 1]) < 2) {
+      printError("NODE NEEDS TWO ROWS AT LEAST TO SPLIT");
+      return false;
+    }
+  }
+
+  if (findOption('z', argc, argv) || findOption('y', argc, argv) || \
+      findOption('f', argc, argv)) {
+    if (!findOption('p', argc, argv) || findOption('l', argc, argv) || !hoeffding) {
+      printError("STREAMING OPTION IS ONLY PROCESSING WITH HOEFFDING TRAINING FOR PREDICTION");
+      return false;
+    }
+    int zIndex = findOption('z', argc, argv);
+    if (zIndex && (atof(argv[zIndex + 1]) <= 0 || atof(argv[zIndex + 1]) >= 1)) {
+      printError("CHANCE OF A WRONG SPLIT MUST BE BETWEEN 0 AND 1");
+      return false;
+    }
+    int yIndex = findOption('y', argc, argv);
+    int fIndex = findOption('f', argc, argv);
+    if ((yIndex && atoi(argv[yIndex + 1]) < 1) || (fIndex && atoi(argv[fIndex + 1]) < 1)) {
+      printError("STREAMING ROWS MUST BE POSITIVE");
+      return false;
+    }
+    if (fIndex && !findOption('s', argc, argv)) {
+      printError("PERIODIC SAVING NEEDS A MODEL FILE ( -s )");
+      return false;
+    }
+  }
+
+  if (findOption('k', argc, argv) || findOption('u', argc, argv)) {
+    int mIndex = findOption('m', argc, argv);
+    if (!findOption('p', argc, argv) || findOption('l', argc, argv) || \
+        !mIndex || strcmp(argv[mIndex + 1], "decision") != 0) {
+      printError("BUDGET IS ONLY PROCESSING WITH DECISION TRAINING FOR PREDICTION");
+      return false;
+    }
+    int kIndex = findOption('k', argc, argv);
+    int uIndex = findOption('u', argc, argv);
+    if ((kIndex && atoi(argv[kIndex + 1]) < 1) || (uIndex && atoi(argv[uIndex + 1]) < 1)) {
+      printError("BUDGET MUST BE POSITIVE");
+      return false;
+    }
+    if (findOption('w', argc, argv)) {
+      printError("BEST-FIRST GROWTH IS NOT PROCESSING WITH LEVEL-WISE GROWTH");
+      return false;
+    }
+  }
+
+  if (findOption('a', argc, argv)) {
+    int mIndex = findOption('m', argc, argv);
+    if (!findOption('p', argc, argv) || findOption('l', argc, argv) || \
+        !mIndex || strcmp(argv[mIndex + 1], "decision") != 0) {
+      printError("BITMAP COUNTING IS ONLY PROCESSING WITH DECISION TRAINING FOR PREDICTION");
+      return false;
+    }
+    if (!ID3::bitmapSupported()) {
+      printError("BITMAP COUNTING NEEDS A CPU WITH POPCOUNT INSTRUCTION");
+      return false;
+    }
+  }
+
+  if (int vIndex = findOption('v', argc, argv)) {
+    int mIndex = findOption('m', argc, argv);
+    if (!findOption('p', argc, argv) || findOption('l', argc, argv) || \
+        !mIndex || strcmp(argv[mIndex + 1], "decision") != 0) {
+      printError("CROSS VALIDATION IS ONLY PROCESSING WITH DECISION TRAINING FOR PREDICTION");
+      return false;
+    }
+    if (atoi(argv[vIndex + 1]) < 2) {
+      printError("CROSS VALIDATION NEEDS TWO FOLDS AT LEAST");
+      return false;
+    }
+  }
+
+  if (findOption('q', argc, argv)) { // query logical check
+    if (findOption('g', argc, argv) || findOption('p', argc, argv)) {
+      printError("QUERY IS NOT PROCESSING WITH GENERATION OR PREDICTION");
+      return false;
+    }
+
+    int mIndex = findOption('m', argc, argv);
+    if (mIndex && strcmp(argv[mIndex + 1], "concept") != 0) {
+      printError("QUERY LEARNING IS ONLY PROCESSING WITH CONCEPT LEARNING");
+      return false;
+    }
+
+    if (mIndex && findOption('x', argc, argv))
+      return true;
+
+    printError("QUERY OPTION ERROR");
+    return false;
+  }
+
   if (findOption('p', argc, argv)) { // prediction logical check
     if (findOption('g', argc, argv)) {
       printError("GENERATION AND PREDICTION ARE NOT PROCESSING SIMULTANEOUSLY");
       return false;
     }
 
+    // incremental state takes more rows and is saved again
+    int mIndex = findOption('m', argc, argv);
+    bool grow = mIndex && strcmp(argv[mIndex + 1], "id5r") == 0;
+    if (findOption('l', argc, argv) && !grow && (findOption('t', argc, argv) || \
+        findOption('s', argc, argv) || findOption('e', argc, argv))) {
+      printError("LOADED MODEL IS NOT PROCESSING WITH TRAINING, SAVING OR EXPORT");
+      return false;
+    }
+
     if (findOption('m', argc, argv) && findOption('i', argc, argv) && \
-        findOption('t', argc, argv))
+        (findOption('t', argc, argv) || findOption('l', argc, argv)))
       return true;
 
     printError("PREDICTION OPTION ERROR");
@@ -247,19 +491,26 @@ bool isWhite(istream *i)
 ////////////////////////////////////////////////////////////////////////////////
 /// 
 /// @brief get integer number from istream
-/// @details next token must be white token or given token
+/// @details next token must be white token or given token; leading '-' @n
+///          makes it negative. Real numbers are not taken, so continuous @n
+///          values must be scaled to integers beforehand.
 ///
 int istream_to_int(istream *i)
 {
   int ret = 0;
+  bool negative = (i->peek() == '-');
+  if (negative)
+    i->get();
   while (!isWhite(i)) {
     ret *= 10;
     int tmp = i->get();
-    if (tmp < 48 || tmp > 57)
+    if (tmp < 48 || tmp > 57) {
+      cout << "///" << "  ERROR : integer value is expected" << endl;
       exit(-1);
+    }
     ret += tmp - 48; // 48 - ASCII code '0' value
   }
-  return ret;
+  return (negative) ? -ret : ret;
 }
 
 int istream_to_int_by_token(istream *i, char token)
@@ -314,13 +565,17 @@ int main(int argc, char* argv[])  ///< taking options
       exit(1);
     }
 
-    // training file stream open
-    training = new ifstream(argv[findOption('t', argc, argv) + 1]);
-    if (!training->is_open()) {
-      input->close();
-      printError("TRAINING FILE OPEN ERROR");
-      namiTerm();
-      exit(1);
+    // training file stream open ( not needed with loaded model )
+    if (int tIndex = findOption('t', argc, argv)) {
+      training = new ifstream(argv[tIndex+1]);
+      if (!training->is_open()) {
+        input->close();
+        printError("TRAINING FILE OPEN ERROR");
+        namiTerm();
+        exit(1);
+      }
+    } else {
+      training = NULL;
     }
 
     // output file stream open
@@ -330,7 +585,8 @@ int main(int argc, char* argv[])  ///< taking options
       output = new ofstream("output.txt");
     if (!output->is_open()) { 
       input->close();
-      training->close();
+      if (training)
+        training->close();
       printError("OUTPUT FILE OPEN ERROR");
       namiTerm();
       exit(1);
@@ -348,18 +604,101 @@ int main(int argc, char* argv[])  ///< taking options
       machine = new CE_Machine(input, training, answer, output);
     } else if (strcmp(mode, "decision") == 0) {
       machine = new ID3_Machine(input, training, answer, output);
+    } else if (strcmp(mode, "forest") == 0) {
+      machine = new Forest_Machine(input, training, answer, output);
+    } else if (strcmp(mode, "boost") == 0) {
+      machine = new Boost_Machine(input, training, answer, output);
+    } else if (strcmp(mode, "disk") == 0) {
+      machine = new Disk_Machine(input, training, answer, output);
+    } else if (strcmp(mode, "id5r") == 0) {
+      machine = new Incremental_Machine(input, training, answer, output);
+    } else if (strcmp(mode, "hoeffding") == 0) {
+      machine = new Hoeffding_Machine(input, training, answer, output);
     } else {
       printError("NO SUCH MODE");
       namiTerm();
       exit(1);
     }
 
-    // do training
-    if (!machine->train()) {
+    // the number of threads
+    if (int jIndex = findOption('j', argc, argv)) //optional
+      machine->setNrThread(atoi(argv[jIndex+1]));
+
+    // level-wise tree growth
+    if (findOption('w', argc, argv)) //optional
+      machine->setLevelWise(true);
+
+    // histogram binned split
+    if (int bIndex = findOption('b', argc, argv)) //optional
+      machine->setNrBin(atoi(argv[bIndex+1]));
+
+    // the number of trees in ensemble
+    if (int nIndex = findOption('n', argc, argv)) //optional
+      machine->setNrTree(atoi(argv[nIndex+1]));
+
+    // the maximum depth of trees
+    if (int dIndex = findOption('d', argc, argv)) //optional
+      machine->setMaxDepth(atoi(argv[dIndex+1]));
+
+    // chi-square pre-pruning and the minimum rows to split
+    if (int cIndex = findOption('c', argc, argv)) //optional
+      machine->setSignificance(atof(argv[cIndex+1]));
+    if (int rIndex = findOption('r', argc, argv)) //optional
+      machine->setMinRows(atoi(argv[rIndex+1]));
+
+    // streaming tree; chance of a wrong split, rows between split checks
+    // and rows between saving the model file
+    if (int zIndex = findOption('z', argc, argv)) //optional
+      machine->setConfidence(atof(argv[zIndex+1]));
+    if (int yIndex = findOption('y', argc, argv)) //optional
+      machine->setGrace(atoi(argv[yIndex+1]));
+    if (int fIndex = findOption('f', argc, argv)) //optional
+      machine->setSnapshot(atoi(argv[fIndex+1]), argv[findOption('s', argc, argv)+1]);
+
+    // node and time budgets of best-first growth
+    int kIndex = findOption('k', argc, argv); //optional
+    int uIndex = findOption('u', argc, argv); //optional
+    if (kIndex || uIndex)
+      machine->setBudget((kIndex) ? atoi(argv[kIndex+1]) : 0,
+        (uIndex) ? atoi(argv[uIndex+1]) : 0);
+
+    // bitmap index counting
+    if (findOption('a', argc, argv)) //optional
+      machine->setBitmap(true);
+
+    // k-fold cross validation before training
+    if (int vIndex = findOption('v', argc, argv)) //optional
+      machine->setNrFold(atoi(argv[vIndex+1]));
+
+    int lIndex = findOption('l', argc, argv);
+    if (lIndex && !machine->loadModel(argv[lIndex+1])) { // load trained model
+      printError("MODEL LOAD ERROR");
+      namiTerm();
+      exit(1);
+    }
+    if ((!lIndex || training) && !machine->train()) { // do training ( on loaded state )
       printError("TRAIN ERROR");
       namiTerm();
       exit(1);
     }
+
+    // save trained model
+    if (int sIndex = findOption('s', argc, argv)) { //optional
+      if (!machine->saveModel(argv[sIndex+1])) {
+        printError("MODEL SAVE ERROR");
+        namiTerm();
+        exit(1);
+      }
+    }
+
+    // export trained model as native code
+    if (int eIndex = findOption('e', argc, argv)) { //optional
+      if (!machine->exportCode(argv[eIndex+1])) {
+        printError("EXPORT ERROR");
+        namiTerm();
+        exit(1);
+      }
+    }
     
     // do predict
     if (!machine->predict()) {
@@ -370,9 +709,64 @@ int main(int argc, char* argv[])  ///< taking options
 
     // close all streams
     input->close();
+    if (training)
+      training->close();
+    if (answer)
+      answer->close();
+    output->close();
+  } else if (findOption('q', argc, argv)) { // do query learning
+    ifstream*      input;     ///< seed training data file stream
+    ofstream*      training;  ///< queried training data file stream
+    ifstream*      answer;    ///< answer data file stream ( oracle )
+    ML_Machine*    machine;   ///< machine learning engine
+
+    // input file stream open
+    if (int iIndex = findOption('i', argc, argv)) { //optional
+      input = new ifstream(argv[iIndex+1]);
+      if (!input->is_open()) {
+        printError("INPUT FILE OPEN ERROR");
+        namiTerm();
+        exit(1);
+      }
+    } else {
+      input = NULL;
+    }
+
+    // answer file stream open
+    answer = new ifstream(argv[findOption('x', argc, argv) + 1]);
+    if (!answer->is_open()) {
+      printError("ANSWER FILE OPEN ERROR");
+      namiTerm();
+      exit(1);
+    }
+
+    // training file stream open
+    if (int tIndex = findOption('t', argc, argv)) //optional
+      training = new ofstream(argv[tIndex+1]);
+    else
+      training = new ofstream("train.txt");
+    if (!training->is_open()) {
+      answer->close();
+      printError("TRAINING FILE OPEN ERROR");
+      namiTerm();
+      exit(1);
+    }
+
+    // option check allows query learning with concept learning only
+    machine = new CE_Machine(input, training, answer, NULL);
+
+    // do query learning
+    if (!machine->query()) {
+      printError("QUERY ERROR");
+      namiTerm();
+      exit(1);
+    }
+
+    // close all streams
+    if (input)
+      input->close();
     training->close();
     answer->close();
-    output->close();
   } else { // do generating input and training data
     ofstream*      input;     ///< new instance file stream
     ofstream*      training;  ///< training data file stream
@@ -421,6 +815,16 @@ int main(int argc, char* argv[])  ///< taking options
       machine = new CE_Machine(input, training, answer, NULL);
     } else if (strcmp(mode, "decision") == 0) {
       machine = new ID3_Machine(input, training, answer, NULL);
+    } else if (strcmp(mode, "forest") == 0) {
+      machine = new Forest_Machine(input, training, answer, NULL);
+    } else if (strcmp(mode, "boost") == 0) {
+      machine = new Boost_Machine(input, training, answer, NULL);
+    } else if (strcmp(mode, "disk") == 0) {
+      machine = new Disk_Machine(input, training, answer, NULL);
+    } else if (strcmp(mode, "id5r") == 0) {
+      machine = new Incremental_Machine(input, training, answer, NULL);
+    } else if (strcmp(mode, "hoeffding") == 0) {
+      machine = new Hoeffding_Machine(input, training, answer, NULL);
     } else {
       printError("NO SUCH MODE");
       namiTerm();
@@ -450,10 +854,100 @@ int main(int argc, char* argv[])  ///< taking options
 ///
 
 ML_Machine::ML_Machine(ios *input, ios *training, ios *answer, ostream *output)
-  : input(input), training(training), answer(answer), output(output) {}
+  : input(input), training(training), answer(answer), output(output) {
+  nr_thread = 0;
+  nr_bin = 0;
+  nr_tree = 64;
+  nr_depth = 0;
+  level = false;
+  significance = 0;
+  nr_min_row = 0;
+  nr_max_node = 0;
+  time_budget = 0;
+  nr_fold = 0;
+  bitmap = false;
+  delta = 0;
+  grace = 0;
+  nr_snapshot = 0;
+  snapshot = NULL;
+}
 
 ML_Machine::~ML_Machine() {}
 
+void ML_Machine::setNrThread(int nr_thread) {
+  this->nr_thread = nr_thread;
+}
+
+void ML_Machine::setNrBin(int nr_bin) {
+  this->nr_bin = nr_bin;
+}
+
+void ML_Machine::setNrTree(int nr_tree) {
+  this->nr_tree = nr_tree;
+}
+
+void ML_Machine::setMaxDepth(int nr_depth) {
+  this->nr_depth = nr_depth;
+}
+
+void ML_Machine::setLevelWise(bool level) {
+  this->level = level;
+}
+
+void ML_Machine::setSignificance(double significance) {
+  this->significance = significance;
+}
+
+void ML_Machine::setMinRows(int nr_min_row) {
+  this->nr_min_row = nr_min_row;
+}
+
+void ML_Machine::setBudget(int nr_max_node, int time_budget) {
+  this->nr_max_node = nr_max_node;
+  this->time_budget = time_budget;
+}
+
+void ML_Machine::setNrFold(int nr_fold) {
+  this->nr_fold = nr_fold;
+}
+
+void ML_Machine::setBitmap(bool bitmap) {
+  this->bitmap = bitmap;
+}
+
+void ML_Machine::setConfidence(double delta) {
+  this->delta = delta;
+}
+
+void ML_Machine::setGrace(int grace) {
+  this->grace = grace;
+}
+
+void ML_Machine::setSnapshot(int nr_snapshot, const char *snapshot) {
+  this->nr_snapshot = nr_snapshot;
+  this->snapshot = snapshot;
+}
+
+bool ML_Machine::query() {
+  cout <<    "///" << "  query learning is not supported for this mode" << endl;
+  return false;
+}
+
+bool ML_Machine::exportCode(const char *) {
+  cout <<    "///" << "  native code export is not supported for this mode" << endl;
+  return false;
+}
+
+bool ML_Machine::saveModel(const char *) {
+  cout <<    "///" << "  model file is not supported for this mode" << endl;
+  return false;
+}
+
+bool ML_Machine::loadModel(const char *) {
+  cout <<    "///" << "  model file is not supported for this mode" << endl;
+  return false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///  CE_Machine
@@ -528,6 +1022,7 @@ bool CE_Machine::predict(void)
   /* these three counters are for perfomance test with generated inputs */
   int total = 0;      ///< the number of total inputs
   int dontknow = 0;   ///< the number of inputs predicted dontknow(?)
+  int voted = 0;      ///< the number of inputs decided by version space voting
   int wrong = 0;      ///< the number of inputs predicted wrong
 
   cout <<    "///" << "  Candidate Elimination Algorithm is predicting..."
@@ -578,7 +1073,19 @@ bool CE_Machine::predict(void)
         (*output) << c << " ";
       }
       char out;
-      switch(ce->predict(in)) {
+      double frac = -1; // fraction of true votes ( only for non-unanimous )
+      Result pred = ce->predict(in);
+      if (pred == r_dontknow) {
+        // not unanimous, so let whole version space vote
+        frac = ce->vote(in);
+        if (frac > 0.5)
+          pred = r_true;
+        else if (frac >= 0 && frac < 0.5)
+          pred = r_false;
+        if (answer && pred != r_dontknow)
+          voted++; // increase voted counter
+      }
+      switch(pred) {
         case r_true: 
           out = 't';
           if (answer)
@@ -600,7 +1107,10 @@ bool CE_Machine::predict(void)
           out = 'x'; 
           break; // error
       }
-      (*output) << "=> " << out << endl;
+      (*output) << "=> " << out;
+      if (frac >= 0)
+        (*output) << " (" << fixed << setprecision(2) << frac << ")";
+      (*output) << endl;
       
       if (answer)
         total++; // increase total counter
@@ -613,6 +1123,7 @@ bool CE_Machine::predict(void)
       cout <<    "///" << "  Perfomance Test Result :"
       << endl << "///" << "    - total :        " << total
       << endl << "///" << "    - dontknow :     " << dontknow
+      << endl << "///" << "    - voted :        " << voted
       << endl << "///" << "    - wrong :        " << wrong
       << endl << "///" << "    - Success Rate : "
       << (total - dontknow - wrong) * 100 / total << " %"
@@ -814,6 +1325,143 @@ unknown input data" << endl;
   return true;
 }
 
+#define MAX_CE_QUERY   1000    ///< the maximum number of queries to an oracle
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///  @brief CE query learning procedure
+///  @details answer file is an oracle labeling each query instance. @n
+///           queried examples are written with training data file format. @n
+///           optional input file ( training data file format ) seeds @n
+///           version space with its first positive example.
+///
+
+bool CE_Machine::query()
+{
+  cout <<    "///" << "  Candidate Elimination Algorithm is querying an oracle..."
+  << endl;
+
+  istream *ans = dynamic_cast <istream*> (answer);
+  ostream *train = dynamic_cast <ostream*> (training);
+  if (!ans || !train)
+    return false;
+
+  // step 1. read answer hypothesis; its length decides attribute number
+  int cap = MAX_CE_ATTR;
+  AttrVal *tmp_a = new AttrVal[cap];
+  size = 0;
+  while (ans->peek() != '\n' && ans->peek() != EOF) {
+    char c = ans->get();
+    if (c == ' ' || c == '\t')
+      continue;
+    if (size == cap) { // grow answer buffer
+      AttrVal *grow = new AttrVal[cap * 2];
+      for (int i = 0; i < size; i++)
+        grow[i] = tmp_a[i];
+      delete [] tmp_a;
+      tmp_a = grow;
+      cap *= 2;
+    }
+    switch(c) {
+      case 't':
+        tmp_a[size++] = vTrue; break;
+      case 'f':
+        tmp_a[size++] = vFalse; break;
+      case '?':
+        tmp_a[size++] = vAllAccept; break;
+      default: // answer file error
+        delete [] tmp_a;
+        return false;
+    }
+  }
+  if (size == 0) {
+    delete [] tmp_a;
+    return false;
+  }
+  Hypothesis *ans_h = new Hypothesis(size, tmp_a);
+
+  ce = new CE(size);
+  double init_vs = ce->sizeVS();
+  int nr_query = 0;
+  bool *q = new bool[size + 1]; // including target attribute
+  bool seeded = false;
+  (*train) << size << endl; // write the number of attributes
+
+  // step 2. seed version space with the first positive example of input.
+  //         while S is empty, G grows without bound and voting over it is
+  //         exponential, so oracle gives a positive example if input has none
+  if (istream *seed = dynamic_cast <istream*> (input)) {
+    bool good = (istream_to_int(seed) == size);
+    ignoreBlank(seed);
+    while (good && !seeded && !seed->eof() && !seed->bad()) {
+      for (int i = 0; good && i < size + 1; i++) {
+        char c = seed->get();
+        good = (c == 't' || c == 'f'); // only 't' or 'f' can read
+        q[i] = (c == 't') ? true : false;
+        ignoreBlank(seed);
+      }
+      seeded = good && q[size];
+    }
+    if (!good) {
+      delete [] q;
+      delete (ans_h);
+      return false;
+    }
+  }
+  if (!seeded) {
+    // the most specific instance answer covers; '?' can take any value
+    for (int i = 0; i < size; i++)
+      q[i] = (tmp_a[i] != vFalse);
+    q[size] = true;
+    seeded = true;
+  }
+
+  // step 3. ask oracle the most informative query until version space converges
+  while (nr_query < MAX_CE_QUERY && ce->sizeVS() > 1) {
+    if (seeded) {
+      seeded = false; // seed example is labeled already
+    } else {
+      double frac = ce->query(q);
+      if (frac <= 0 || frac >= 1) // no instance splits version space
+        break;
+      q[size] = ans_h->isCover(q); // oracle labeling
+    }
+
+    for (int i = 0; i < size + 1; i++) {
+      (*train) << ((q[i]) ? 't' : 'f');
+      if (i < size)
+        (*train) << " ";
+    }
+    (*train) << endl;
+
+    if (!ce->updateVS(q)) {
+      delete [] q;
+      delete (ans_h);
+      return false;
+    }
+    nr_query++;
+  }
+
+  cout <<    "///" << "                               -- finish"
+  << endl << "///" << endl;
+
+  ios::fmtflags flags = cout.flags();
+  streamsize precision = cout.precision();
+  cout <<    "///" << "  Query Result :"
+  << endl << "///" << "    - queries :          " << nr_query
+  << endl << "///" << "    - log2 |VS| :        " << fixed << setprecision(2)
+  << log(init_vs) / log((double)2)
+  << endl << "///" << "    - final |VS| :       " << setprecision(0) << ce->sizeVS()
+  << endl << "///" << endl;
+  cout.flags(flags);
+  cout.precision(precision);
+
+  delete [] q;
+  delete (ans_h);
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///  ID3_Machine
@@ -835,74 +1483,78 @@ ID3_Machine::~ID3_Machine() {
 ///  @brief ID3 train procedure
 ///  @details train text file format
 ///           1st line :  the number of attr
-///           2nd line :  attr size array
-///           3rd line~:  train data ...
+///           2nd line :  attr size array ( 0 : continuous attr )
+///           3rd line~:  train data ... ( signed integers for continuous @n
+///                       attr; real values must be scaled beforehand )
 ///
 
-bool ID3_Machine::train()
+bool ID3_Machine::readHeader(istream *train, int &nr_row)
 {
-  cout <<    "///" << "  ID3 Algorithm is training..."
-  << endl;
+  // get the number of attributes
+  nr_att = istream_to_int(train);
+  ignoreBlank(train);
+  
+  attSizes = new ATTVAL[nr_att];
+  // get the size of each attributes
+  for (int i = 0; i < nr_att; i++) {
+    attSizes[i] = (ATTVAL) istream_to_int(train);
+    ignoreBlank(train);
+  }
+  this->attSizes = attSizes;
+
+  // size 0 means continuous attr, but target attr must be nominal
+  if (attSizes[nr_att - 1] <= 0) {
+    cout << "///" << "  ERROR : target attribute must have values" << endl;
+    return false;
+  }
+  
+  // get the size of real data in train
+  nr_row = istream_to_int(train);
+  ignoreBlank(train);
+  return true;
+}
 
-  ATTVAL **train_dat = NULL;
-  ATTVAL **valid_dat = NULL;
+bool ID3_Machine::readTrain(DataSet **train_dat, DataSet **valid_dat)
+{
   int nr_train = 0;
   int nr_valid = 0;
 
   // training should reference istream class
   if (istream *train = dynamic_cast <istream*> (training)) {
-    // get the number of attributes
-    nr_att = istream_to_int(train);
-    ignoreBlank(train);
-    
-    attSizes = new ATTVAL[nr_att];
-    // get the size of each attributes
-    for (int i = 0; i < nr_att; i++) {
-      attSizes[i] = (ATTVAL) istream_to_int(train);
-      ignoreBlank(train);
-    }
-    this->attSizes = attSizes;
-    
-    // get the size of real data in train
-    int full_size_of_train = istream_to_int(train);
-    ignoreBlank(train);
+    int full_size_of_train = 0;
+    if (!readHeader(train, full_size_of_train))
+      return false;
     
     // define the size of train & validation set
-    nr_valid = full_size_of_train / 4;
+    nr_valid = (valid_dat) ? full_size_of_train / 4 : 0;
     nr_train = full_size_of_train - nr_valid;
-    train_dat = new ATTVAL*[nr_train];
-    for (int i = 0; i < nr_train; i++)
-      train_dat[i] = new ATTVAL[nr_att];
-    valid_dat = new ATTVAL*[nr_valid];
-    for (int i = 0; i < nr_valid; i++)
-      valid_dat[i] = new ATTVAL[nr_att];
-   
-    // create ID3 engine
-    id3 = new ID3(attSizes, nr_att, train_dat, valid_dat, nr_train, nr_valid);
+    *train_dat = new DataSet(nr_att, nr_train, attSizes);
+    if (valid_dat)
+      *valid_dat = new DataSet(nr_att, nr_valid, attSizes);
 
     int cur_pos = 0;
     do {
       for (int i = 0; i < nr_att; i++) {
         ATTVAL tmp = (ATTVAL) istream_to_int(train);
         ignoreBlank(train);
+        if (attSizes[i] > 0 && (tmp < 0 || tmp >= attSizes[i])) {
+          cout << "///" << "  ERROR : attribute value is out of range at row " << cur_pos << endl;
+          delete (*train_dat);
+          *train_dat = NULL;
+          if (valid_dat) {
+            delete (*valid_dat);
+            *valid_dat = NULL;
+          }
+          return false;
+        }
         if (cur_pos < nr_valid) { // validation set
-          valid_dat[cur_pos][i] = tmp;
+          (*valid_dat)->setVal(cur_pos, i, tmp);
         } else { // train set
-          train_dat[cur_pos - nr_valid][i] = tmp;
+          (*train_dat)->setVal(cur_pos - nr_valid, i, tmp);
         }
       }
       cur_pos++;
-    } while (!train->eof() && !train->bad());
-    
-    cout <<    "///" << "    - making a decision tree" << endl;
-    cout <<    "///" << endl;
-    id3->makeTree(); // train decision tree
-    cout << endl << "///" << endl;
-    cout <<    "///" << "    - pruning the decision tree" << endl;
-    id3->prune(); // prune decision tree
-
-    cout <<    "///" << "                               -- finish"
-    << endl << "///" << endl;
+    } while (!train->eof() && !train->bad() && cur_pos < full_size_of_train);
 
     return true;
   } else { // reference error
@@ -912,6 +1564,98 @@ bool ID3_Machine::train()
   return false; // code error
 }
 
+bool ID3_Machine::train()
+{
+  cout <<    "///" << "  ID3 Algorithm is training..."
+  << endl;
+
+  DataSet *train_dat = NULL;
+  DataSet *valid_dat = NULL;
+  if (nr_fold > 0) {
+    // folds take every row; the validation quarter is split off afterwards
+    DataSet *all = NULL;
+    if (!readTrain(&all, NULL))
+      return false;
+    if (!crossValidate(all)) {
+      delete (all);
+      return false;
+    }
+    int nr_valid = all->getNrRow() / 4;
+    train_dat = new DataSet(nr_att, all->getNrRow() - nr_valid, attSizes);
+    valid_dat = new DataSet(nr_att, nr_valid, attSizes);
+    for (int r = 0; r < all->getNrRow(); r++)
+      for (int i = 0; i < nr_att; i++) {
+        if (r < nr_valid)
+          valid_dat->setVal(r, i, all->getVal(r, i));
+        else
+          train_dat->setVal(r - nr_valid, i, all->getVal(r, i));
+      }
+    delete (all);
+  } else if (!readTrain(&train_dat, &valid_dat))
+    return false;
+   
+  // create ID3 engine
+  id3 = new ID3(attSizes, nr_att, train_dat, valid_dat);
+  id3->setNrThread(nr_thread);
+  id3->setNrBin(nr_bin);
+  id3->setLevelWise(level);
+  id3->setMaxDepth(nr_depth);
+  id3->setSignificance(significance);
+  id3->setMinRows(nr_min_row);
+  id3->setBudget(nr_max_node, time_budget);
+  id3->setBitmap(bitmap);
+    
+  cout <<    "///" << "    - making a decision tree" << endl;
+  cout <<    "///" << endl;
+  id3->makeTree(); // train decision tree
+  cout << endl << "///" << endl;
+  cout <<    "///" << "    - pruning the decision tree" << endl;
+  id3->prune(); // prune decision tree
+
+  cout <<    "///" << "                               -- finish"
+  << endl << "///" << endl;
+
+  return true;
+}
+
+bool ID3_Machine::crossValidate(DataSet *all)
+{
+  if (all->getNrRow() < nr_fold) {
+    cout << "///" << "  ERROR : fewer training rows than cross validation folds" << endl;
+    return false;
+  }
+
+  cout <<    "///" << "    - cross validating " << nr_fold << " folds" << endl;
+  CrossValid *cv = new CrossValid(attSizes, nr_att, all, nr_fold);
+  cv->setNrThread(nr_thread);
+  cv->setNrBin(nr_bin);
+  cv->setLevelWise(level);
+  cv->setMaxDepth(nr_depth);
+  cv->setSignificance(significance);
+  cv->setMinRows(nr_min_row);
+  cv->setBudget(nr_max_node, time_budget);
+  cv->setBitmap(bitmap);
+  cv->validate();
+
+  // report is fixed point; console format is restored for later lines
+  ios::fmtflags flags = cout.flags();
+  streamsize precision = cout.precision();
+  for (int f = 0; f < nr_fold; f++)
+    cout << "///" << "      fold " << f << " : accuracy "
+      << fixed << setprecision(4) << cv->getAccuracy(f) << ", "
+      << setprecision(1) << cv->getMsec(f) << " msec, "
+      << cv->getNrNode(f) << " nodes" << endl;
+  cout << "///" << "      mean accuracy " << setprecision(4) << cv->getMean()
+    << " ( stddev " << cv->getStdDev() << " )" << endl;
+  cout.flags(flags);
+  cout.precision(precision);
+  delete (cv);
+
+  return true;
+}
+
+#define PREDICT_ROWS   (1 << 14) ///< the number of instances parsed and predicted at once
+
 bool ID3_Machine::predict()
 {
   /* these three counters are for perfomance test with generated inputs */
@@ -932,23 +1676,38 @@ bool ID3_Machine::predict()
       ans_tree->setNrAtt(nr_att);
     }
     
+    // parse a block of instances, predict them together, then write them
+    int stride = nr_att - 1; // except for target attr
+    ATTVAL *in = new ATTVAL[PREDICT_ROWS * stride];
+    ATTVAL *out = new ATTVAL[PREDICT_ROWS];
     do {
-      ATTVAL* in = new ATTVAL[nr_att - 1]; // except for target attr
-      for (int i = 0; i < nr_att - 1; i++) {
-        in[i] = istream_to_int(inp);
-        ignoreBlank(inp);
-        // update output too
-        (*output) << in[i] << " ";
-      }
-      ATTVAL out = id3->predict(in);
-      (*output) << "=> " << out << endl;
-      if (answer) {
-        if (out != ans_tree->getLeaf(in)->getVal())
-          wrong++;
-        total++; // increase total counter
+      int nr_in = 0;
+      do {
+        ATTVAL *row = in + nr_in * stride;
+        for (int i = 0; i < stride; i++) {
+          row[i] = istream_to_int(inp);
+          ignoreBlank(inp);
+        }
+        nr_in++;
+      } while (nr_in < PREDICT_ROWS && !inp->eof() && !inp->bad());
+
+      predictBatch(in, nr_in, out);
+
+      for (int r = 0; r < nr_in; r++) {
+        ATTVAL *row = in + r * stride;
+        for (int i = 0; i < stride; i++)
+          (*output) << row[i] << " ";
+        (*output) << "=> " << out[r] << '\n';
+        if (answer) {
+          if (out[r] != ans_tree->getLeaf(row)->getVal())
+            wrong++;
+          total++; // increase total counter
+        }
       }
-      delete []in;
     } while (!inp->eof() && !inp->bad());
+    output->flush();
+    delete [] in;
+    delete [] out;
 
     cout <<    "///" << "                               -- finish"
     << endl << "///" << endl;
@@ -971,6 +1730,11 @@ bool ID3_Machine::predict()
   return false; // code error
 }
 
+void ID3_Machine::predictBatch(const ATTVAL *rows, size_t n, ATTVAL *out)
+{
+  id3->predictBatch(rows, n, out);
+}
+
 void ID3_Machine::recursive_make_answer_tree(DTreeRoot *parent, bool *remainAtt, 
   ostream *ans, int indent, bool first, bool last, DTree *tree, int ch_index) {
   // count the number of remaining attrs
@@ -1150,7 +1914,8 @@ training data..." << endl;
   cout <<    "///" << "  - Training Data File Format:" << endl;
   cout <<    "///" << "   top of line         : the number of attributes \
 including target attr" << endl;
-  cout <<    "///" << "   second line         : attribute size array" << endl;
+  cout <<    "///" << "   second line         : attribute size array \
+( 0 : continuous attr of signed integers )" << endl;
   cout <<    "///" << "   the following lines : sets of integer value \
 represented training data" << endl;
   cout <<    "///" << endl;
@@ -1309,3 +2074,487 @@ void ID3_Machine::recursive_answer_tree_gen(DTreeRoot *parent, istream *ans,
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @brief compiling exported source to shared object
+/// @details compiler runs without shell, so paths are passed as they are; @n
+///          relative path starting with '-' is not taken as an option
+///
+static bool compileShared(const char *so, const char *src)
+{
+  string out = (so[0] == '-') ? string("./") + so : string(so);
+  string in = (src[0] == '-') ? string("./") + src : string(src);
+  const char *argv[] = { "c++", "-O2", "-shared", "-fPIC", "-o", out.c_str(),
+    in.c_str(), NULL };
+
+  pid_t pid = fork();
+  if (pid < 0)
+    return false;
+  if (pid == 0) {
+    execvp(argv[0], (char* const*) argv);
+    _exit(127); // compiler not found
+  }
+  int status = 0;
+  if (waitpid(pid, &status, 0) != pid)
+    return false;
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+bool ID3_Machine::exportCode(const char *path)
+{
+  if (!id3 || !id3->getTree() || !path)
+    return false;
+
+  // shared object is compiled from source written next to it
+  size_t len = strlen(path);
+  bool so = (len > 3 && strcmp(path + len - 3, ".so") == 0);
+  string src = (so) ? string(path) + ".cpp" : string(path);
+
+  ofstream code(src.c_str());
+  if (!code.is_open())
+    return false;
+  id3->getTree()->exportCode(&code);
+  code.close();
+
+  if (so && !compileShared(path, src.c_str()))
+    return false;
+
+  cout <<    "///" << "  ID3 Algorithm exported the decision tree to " << path
+  << endl << "///" << endl;
+  return true;
+}
+
+bool ID3_Machine::saveModel(const char *path)
+{
+  if (!id3 || !path || !id3->save(path))
+    return false;
+
+  cout <<    "///" << "  ID3 Algorithm saved the model to " << path
+  << endl << "///" << endl;
+  return true;
+}
+
+bool ID3_Machine::loadModel(const char *path)
+{
+
+  cout <<    "///" << "  ID3 Algorithm is loading a model..."
+  << endl;
+
+  FlatTree *flat = FlatTree::load(path);
+  if (!flat)
+    return false;
+
+  nr_att = flat->getNrAtt();
+  attSizes = new ATTVAL[nr_att];
+  for (int i = 0; i < nr_att; i++)
+    attSizes[i] = flat->getAttSizeArray()[i];
+
+  id3 = new ID3(flat);
+  id3->setNrThread(nr_thread);
+
+  cout <<    "///" << "    - " << flat->getNrNode() << " nodes from " << path
+  << endl << "///" << "                               -- finish"
+  << endl << "///" << endl;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///  Ensemble_Machine
+///
+
+Ensemble_Machine::Ensemble_Machine(ios *input, ios *training, ios *answer, ostream *output)
+  : ID3_Machine(input, training, answer, output) {
+}
+
+bool Ensemble_Machine::exportCode(const char *path)
+{
+  return ML_Machine::exportCode(path);
+}
+
+bool Ensemble_Machine::saveModel(const char *path)
+{
+  return ML_Machine::saveModel(path);
+}
+
+bool Ensemble_Machine::loadModel(const char *path)
+{
+  return ML_Machine::loadModel(path);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///  Forest_Machine
+///
+
+Forest_Machine::Forest_Machine(ios *input, ios *training, ios *answer, ostream *output)
+  : Ensemble_Machine(input, training, answer, output) {
+  forest = NULL;
+}
+
+Forest_Machine::~Forest_Machine() {
+  if (forest)
+    delete(forest);
+}
+
+bool Forest_Machine::train()
+{
+  cout <<    "///" << "  Random Forest is training..."
+  << endl;
+
+  DataSet *data = NULL;
+  if (!readTrain(&data, NULL))
+    return false;
+
+  // create forest engine; every row is for training
+  forest = new Forest(attSizes, nr_att, data, nr_tree);
+  forest->setNrThread(nr_thread);
+  forest->setNrBin(nr_bin);
+  forest->setLevelWise(level);
+  forest->setMaxDepth(nr_depth);
+  forest->setSignificance(significance);
+  forest->setMinRows(nr_min_row);
+
+  cout <<    "///" << "    - making " << nr_tree << " trees on bootstrap samples" << endl;
+  forest->makeForest();
+  ios::fmtflags flags = cout.flags();
+  streamsize precision = cout.precision();
+  cout <<    "///" << "    - out-of-bag error rate : " << fixed << setprecision(2)
+  << forest->getOOBError() * 100 << " %" << endl;
+  cout.flags(flags);
+  cout.precision(precision);
+
+  cout <<    "///" << "                               -- finish"
+  << endl << "///" << endl;
+
+  return true;
+}
+
+void Forest_Machine::predictBatch(const ATTVAL *rows, size_t n, ATTVAL *out)
+{
+  forest->predictBatch(rows, n, out);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///  Boost_Machine
+///
+
+Boost_Machine::Boost_Machine(ios *input, ios *training, ios *answer, ostream *output)
+  : Ensemble_Machine(input, training, answer, output) {
+  boost = NULL;
+}
+
+Boost_Machine::~Boost_Machine() {
+  if (boost)
+    delete(boost);
+}
+
+bool Boost_Machine::train()
+{
+  cout <<    "///" << "  AdaBoost is training..."
+  << endl;
+
+  DataSet *data = NULL;
+  if (!readTrain(&data, NULL))
+    return false;
+
+  // create boosting engine; every row is for training, stumps by default
+  int depth = (nr_depth > 0) ? nr_depth : 1;
+  boost = new Boost(attSizes, nr_att, data, nr_tree, depth);
+  boost->setNrThread(nr_thread);
+  boost->setNrBin(nr_bin);
+  boost->setLevelWise(level);
+  boost->setSignificance(significance);
+  boost->setMinRows(nr_min_row);
+
+  cout <<    "///" << "    - boosting " << nr_tree << " rounds of depth " << depth
+  << " trees" << endl;
+  boost->makeBoost();
+  ios::fmtflags flags = cout.flags();
+  streamsize precision = cout.precision();
+  cout <<    "///" << "    - training error rate : " << fixed << setprecision(2)
+  << boost->getTrainError() * 100 << " %" << endl;
+  cout.flags(flags);
+  cout.precision(precision);
+
+  cout <<    "///" << "                               -- finish"
+  << endl << "///" << endl;
+
+  return true;
+}
+
+void Boost_Machine::predictBatch(const ATTVAL *rows, size_t n, ATTVAL *out)
+{
+  boost->predictBatch(rows, n, out);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///  Disk_Machine
+///
+
+Disk_Machine::Disk_Machine(ios *input, ios *training, ios *answer, ostream *output)
+  : ID3_Machine(input, training, answer, output) {}
+
+Disk_Machine::~Disk_Machine() {}
+
+bool Disk_Machine::train()
+{
+  cout <<    "///" << "  Out-of-core ID3 Algorithm is training..."
+  << endl;
+
+  // training file is read again for each level, so it must be seekable
+  istream *train = dynamic_cast <istream*> (training);
+  if (!train)
+    return false;
+  int nr_row = 0;
+  if (!readHeader(train, nr_row) || nr_row < 1)
+    return false;
+  if (train->tellg() < 0) {
+    cout << "///" << "  ERROR : training file must be seekable" << endl;
+    return false;
+  }
+
+  if (significance > 0) {
+    cout << "///" << "  ERROR : chi-square pre-pruning is not supported out of core" << endl;
+    return false;
+  }
+
+  DiskID3 *disk = new DiskID3(attSizes, nr_att, train, nr_row);
+  disk->setNrBin(nr_bin);
+  disk->setMaxDepth(nr_depth);
+  disk->setMinRows(nr_min_row);
+
+  cout <<    "///" << "    - making a decision tree level by level" << endl;
+  if (!disk->makeTree()) {
+    cout << "///" << "  ERROR : attribute value is malformed or out of range at row "
+    << disk->getBadRow() << endl;
+    delete (disk);
+    return false;
+  }
+  cout <<    "///" << "    - pruning the decision tree" << endl;
+  disk->prune();
+
+  // the tree predicts, exports and saves like the in-memory one
+  id3 = new ID3(disk->takeTree());
+  id3->setNrThread(nr_thread);
+  delete (disk);
+
+  cout <<    "///" << "                               -- finish"
+  << endl << "///" << endl;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///  Incremental_Machine
+///
+
+Incremental_Machine::Incremental_Machine(ios *input, ios *training, ios *answer,
+  ostream *output) : ID3_Machine(input, training, answer, output) {
+  id5r = NULL;
+}
+
+Incremental_Machine::~Incremental_Machine() {
+  if (id5r)
+    delete(id5r);
+}
+
+bool Incremental_Machine::train()
+{
+  cout <<    "///" << "  Incremental ID3 ( ID5R ) is training..."
+  << endl;
+
+  istream *train = dynamic_cast <istream*> (training);
+  if (!train)
+    return false;
+
+  // rows of loaded state must have the same attributes
+  ATTVAL *loaded = attSizes;
+  int nr_loaded = nr_att;
+  int nr_row = 0;
+  if (!readHeader(train, nr_row) || nr_row < 1)
+    return false;
+  if (id5r) {
+    bool same = (nr_att == nr_loaded);
+    for (int i = 0; same && i < nr_att; i++)
+      same = (attSizes[i] == loaded[i]);
+    delete [] attSizes;
+    attSizes = loaded;
+    nr_att = nr_loaded;
+    if (!same) {
+      cout << "///" << "  ERROR : training attributes differ from the loaded state" << endl;
+      return false;
+    }
+  }
+  for (int i = 0; i < nr_att - 1; i++) {
+    if (attSizes[i] <= 0) {
+      cout << "///" << "  ERROR : incremental tree needs nominal attributes" << endl;
+      return false;
+    }
+  }
+
+  if (!id5r)
+    id5r = new ID5R(attSizes, nr_att);
+  int nr_before = id5r->getNrRow();
+  int restruct_before = id5r->getNrRestruct();
+  ATTVAL *row = new ATTVAL[nr_att];
+  bool good = true;
+
+  cout <<    "///" << "    - adding training rows one by one" << endl;
+  for (int r = 0; r < nr_row && !train->eof() && !train->bad(); r++) {
+    for (int i = 0; i < nr_att; i++) {
+      row[i] = (ATTVAL) istream_to_int(train);
+      ignoreBlank(train);
+      if (row[i] < 0 || row[i] >= attSizes[i])
+        good = false;
+    }
+    if (!good) {
+      cout << "///" << "  ERROR : attribute value is out of range at row " << r << endl;
+      break;
+    }
+    id5r->addRow(row);
+  }
+  delete [] row;
+  if (!good)
+    return false;
+
+  // the tree predicts, exports and saves like the batch one
+  cout <<    "///" << "    - restructuring the decision tree" << endl;
+  id3 = new ID3(id5r->makeDTree());
+  cout <<    "///" << "      " << id5r->getNrRow() - nr_before << " rows added to "
+  << nr_before << " ( " << id5r->getNrRestruct() - restruct_before
+  << " restructurings ), " << id5r->getNrNode() << " nodes" << endl;
+  id3->setNrThread(nr_thread);
+
+  cout <<    "///" << "                               -- finish"
+  << endl << "///" << endl;
+
+  return true;
+}
+
+bool Incremental_Machine::saveModel(const char *path)
+{
+  if (!id5r || !path || !id5r->save(path))
+    return false;
+
+  cout <<    "///" << "  Incremental ID3 ( ID5R ) saved its state to " << path
+  << endl << "///" << endl;
+  return true;
+}
+
+bool Incremental_Machine::loadModel(const char *path)
+{
+  cout <<    "///" << "  Incremental ID3 ( ID5R ) is loading a state..."
+  << endl;
+
+  id5r = ID5R::load(path, &attSizes, &nr_att);
+  if (!id5r)
+    return false;
+  cout <<    "///" << "    - " << id5r->getNrRow() << " rows from " << path << endl;
+
+  // without new rows, the loaded tree predicts as it is
+  if (!training) {
+    id3 = new ID3(id5r->makeDTree());
+    id3->setNrThread(nr_thread);
+    cout <<    "///" << "    - " << id5r->getNrNode() << " nodes" << endl;
+  }
+
+  cout <<    "///" << "                               -- finish"
+  << endl << "///" << endl;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///
+///  Hoeffding_Machine
+///
+
+#define HOEFF_REPORT  (1 << 20) ///< rows between progress lines
+
+Hoeffding_Machine::Hoeffding_Machine(ios *input, ios *training, ios *answer,
+  ostream *output) : ID3_Machine(input, training, answer, output) {}
+
+Hoeffding_Machine::~Hoeffding_Machine() {}
+
+bool Hoeffding_Machine::saveSnapshot(const Hoeffding *vfdt)
+{
+  // readers never see a half-written model; rename replaces it at once
+  string tmp = string(snapshot) + ".tmp";
+  ID3 *snap = new ID3(vfdt->makeDTree());
+  bool saved = snap->save(tmp.c_str()) && rename(tmp.c_str(), snapshot) == 0;
+  delete (snap);
+  if (!saved) {
+    cout << "///" << "  ERROR : model file cannot be saved to " << snapshot << endl;
+    return false;
+  }
+  cout << "///" << "      " << vfdt->getNrRow() << " rows, saved to " << snapshot << endl;
+  return true;
+}
+
+bool Hoeffding_Machine::train()
+{
+  cout <<    "///" << "  Hoeffding tree ( VFDT ) is training..."
+  << endl;
+
+  istream *train = dynamic_cast <istream*> (training);
+  if (!train)
+    return false;
+  int nr_row = 0; // 0 or less means rows until end of stream
+  if (!readHeader(train, nr_row))
+    return false;
+  for (int i = 0; i < nr_att - 1; i++) {
+    if (attSizes[i] <= 0) {
+      cout << "///" << "  ERROR : streaming tree needs nominal attributes" << endl;
+      return false;
+    }
+  }
+
+  Hoeffding *vfdt = new Hoeffding(attSizes, nr_att);
+  vfdt->setConfidence(delta);
+  vfdt->setGrace(grace);
+  vfdt->setMaxDepth(nr_depth);
+  ATTVAL *row = new ATTVAL[nr_att];
+  bool good = true;
+
+  cout <<    "///" << "    - streaming training rows once" << endl;
+  for (long r = 0; (nr_row <= 0 || r < nr_row) && !train->eof() && !train->bad(); r++) {
+    for (int i = 0; i < nr_att; i++) {
+      row[i] = (ATTVAL) istream_to_int(train);
+      ignoreBlank(train);
+      if (row[i] < 0 || row[i] >= attSizes[i])
+        good = false;
+    }
+    if (!good) {
+      cout << "///" << "  ERROR : attribute value is out of range at row " << r << endl;
+      break;
+    }
+    vfdt->addRow(row);
+    if ((r + 1) % HOEFF_REPORT == 0)
+      cout << "///" << "      " << r + 1 << " rows, " << vfdt->getNrNode() << " nodes" << endl;
+    if (nr_snapshot > 0 && (r + 1) % nr_snapshot == 0 && !saveSnapshot(vfdt)) {
+      good = false;
+      break;
+    }
+  }
+  delete [] row;
+  if (!good || vfdt->getNrRow() < 1) {
+    delete (vfdt);
+    return false;
+  }
+
+  // the tree predicts, exports and saves like the batch one
+  cout <<    "///" << "    - making the decision tree" << endl;
+  id3 = new ID3(vfdt->makeDTree());
+  cout <<    "///" << "      " << vfdt->getNrRow() << " rows ( " << vfdt->getNrSplit()
+  << " splits ), " << vfdt->getNrNode() << " nodes" << endl;
+  id3->setNrThread(nr_thread);
+  delete (vfdt);
+
+  cout <<    "///" << "                               -- finish"
+  << endl << "///" << endl;
+
+  return true;
+}
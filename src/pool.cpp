@@ -0,0 +1,198 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// @file pool.cpp
+/// @brief Thread Pool Library Source File
+/// @details Work-stealing task pool based on pthread.
+///
+/// @section purpose_section Purpose
+/// Parallel execution of independent learning steps
+///
+
+#include "pool.h"
+#include <unistd.h>
+
+static __thread WorkPool *tls_pool = NULL;  ///< pool of current worker thread
+static __thread int tls_slot = -1;          ///< deque index of current worker thread
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// TaskGroup class implementation
+///
+
+TaskGroup::TaskGroup() {
+  nr_pending = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// WorkPool class implementation
+///
+
+WorkPool::WorkPool(int nr_thread) {
+  if (nr_thread <= 0)
+    nr_thread = nrCore();
+  this->nr_thread = nr_thread;
+  nr_queued = 0;
+  nr_sleeping = 0;
+  stop = false;
+  pthread_mutex_init(&lock, NULL);
+  pthread_cond_init(&cond, NULL);
+
+  deques = new Deque[nr_thread];
+  for (int i = 0; i < nr_thread; i++) {
+    pthread_mutex_init(&deques[i].lock, NULL);
+    deques[i].top = NULL;
+    deques[i].bottom = NULL;
+  }
+
+  threads = new pthread_t[nr_thread];
+  workers = new Worker[nr_thread];
+  for (int i = 0; i < nr_thread - 1; i++) {
+    workers[i].pool = this;
+    workers[i].slot = i;
+    pthread_create(&threads[i], NULL, workerMain, &workers[i]);
+  }
+}
+
+WorkPool::~WorkPool() {
+  pthread_mutex_lock(&lock);
+  stop = true;
+  pthread_cond_broadcast(&cond);
+  pthread_mutex_unlock(&lock);
+
+  for (int i = 0; i < nr_thread - 1; i++)
+    pthread_join(threads[i], NULL);
+  delete [] threads;
+  delete [] workers;
+
+  for (int i = 0; i < nr_thread; i++)
+    pthread_mutex_destroy(&deques[i].lock);
+  delete [] deques;
+
+  pthread_mutex_destroy(&lock);
+  pthread_cond_destroy(&cond);
+}
+
+int WorkPool::getNrThread() const {
+  return nr_thread;
+}
+
+int WorkPool::nrCore() {
+  long nr = sysconf(_SC_NPROCESSORS_ONLN);
+  return (nr > 0) ? (int) nr : 1;
+}
+
+int WorkPool::mySlot() const {
+  return (tls_pool == this) ? tls_slot : nr_thread - 1;
+}
+
+void WorkPool::spawn(TaskGroup *group, TASKFUNC func, void *arg) {
+  Task *task = new Task;
+  task->func = func;
+  task->arg = arg;
+  task->group = group;
+  task->next = NULL;
+  __sync_fetch_and_add(&group->nr_pending, 1);
+
+  // push at bottom of own deque
+  Deque *dq = &deques[mySlot()];
+  pthread_mutex_lock(&dq->lock);
+  task->prev = dq->bottom;
+  if (dq->bottom)
+    dq->bottom->next = task;
+  else
+    dq->top = task;
+  dq->bottom = task;
+  pthread_mutex_unlock(&dq->lock);
+
+  __sync_fetch_and_add(&nr_queued, 1);
+  if (__sync_fetch_and_add(&nr_sleeping, 0) > 0) {
+    pthread_mutex_lock(&lock);
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&lock);
+  }
+}
+
+WorkPool::Task* WorkPool::takeTask(int slot) {
+  if (__sync_fetch_and_add(&nr_queued, 0) == 0)
+    return NULL;
+
+  for (int i = 0; i < nr_thread; i++) {
+    Deque *dq = &deques[(slot + i) % nr_thread];
+    Task *task = NULL;
+
+    pthread_mutex_lock(&dq->lock);
+    if (i == 0 && dq->bottom) { // own deque; pop the newest
+      task = dq->bottom;
+      dq->bottom = task->prev;
+      if (dq->bottom)
+        dq->bottom->next = NULL;
+      else
+        dq->top = NULL;
+    } else if (i != 0 && dq->top) { // other deque; steal the oldest
+      task = dq->top;
+      dq->top = task->next;
+      if (dq->top)
+        dq->top->prev = NULL;
+      else
+        dq->bottom = NULL;
+    }
+    pthread_mutex_unlock(&dq->lock);
+
+    if (task) {
+      __sync_fetch_and_sub(&nr_queued, 1);
+      return task;
+    }
+  }
+
+  return NULL;
+}
+
+void WorkPool::runTask(Task *task) {
+  task->func(task->arg);
+
+  if (__sync_sub_and_fetch(&task->group->nr_pending, 1) == 0) {
+    pthread_mutex_lock(&lock);
+    pthread_cond_broadcast(&cond); // wake waiting threads
+    pthread_mutex_unlock(&lock);
+  }
+  delete task;
+}
+
+void WorkPool::sleep(TaskGroup *group) {
+  pthread_mutex_lock(&lock);
+  __sync_fetch_and_add(&nr_sleeping, 1);
+  while (__sync_fetch_and_add(&nr_queued, 0) == 0 && !stop &&
+      (group == NULL || group->nr_pending > 0))
+    pthread_cond_wait(&cond, &lock);
+  __sync_fetch_and_sub(&nr_sleeping, 1);
+  pthread_mutex_unlock(&lock);
+}
+
+void WorkPool::wait(TaskGroup *group) {
+  int slot = mySlot();
+
+  while (__sync_fetch_and_add(&group->nr_pending, 0) > 0) {
+    // help running tasks rather than sleeping
+    if (Task *task = takeTask(slot))
+      runTask(task);
+    else
+      sleep(group);
+  }
+}
+
+void* WorkPool::workerMain(void *arg) {
+  Worker *worker = (Worker*) arg;
+  WorkPool *pool = worker->pool;
+  tls_pool = pool;
+  tls_slot = worker->slot;
+
+  while (!pool->stop) {
+    if (Task *task = pool->takeTask(worker->slot))
+      pool->runTask(task);
+    else
+      pool->sleep(NULL);
+  }
+
+  return NULL;
+}